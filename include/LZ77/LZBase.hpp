@@ -1,15 +1,31 @@
 #pragma once
 
+#include <cstring>
+#include <vector>
+
 #include "LZ77/LZLookupTable.hpp"
 
+namespace athena::io::Compression {
+enum class Status;
+} // namespace athena::io::Compression
+
 class LZBase {
 public:
+  static constexpr atInt32 MaxParseEffort = 9;
+
   explicit LZBase(atInt32 minimumOffset = 1, atInt32 slidingWindow = 4096, atInt32 minimumMatch = 3,
                   atInt32 blockSize = 8);
   virtual ~LZBase();
 
   virtual atUint32 compress(const atUint8* src, atUint8** dest, atUint32 srcLength) = 0;
   virtual atUint32 decompress(const atUint8* src, atUint8** dest, atUint32 srcLength) = 0;
+  // Decodes src into dst, which has room for dstCap bytes, and sets decompressedLen to the size the header records.
+  // Matches are copied 8 bytes at a time while dst has room past them, a little spare capacity speeds up the end.
+  virtual athena::io::Compression::Status decompressInto(const atUint8* src, size_t srcLen, atUint8* dst,
+                                                         size_t dstCap, size_t& decompressedLen) const = 0;
+  // Reads the decompressed size from a type 0x10 or 0x11 header, along with the header's own size
+  static athena::io::Compression::Status readHeader(const atUint8* src, size_t srcLen, size_t& size,
+                                                    size_t& headerSize);
 
   void setSlidingWindow(atInt32 SlidingWindow);
   atInt32 slidingWindow() const;
@@ -21,9 +37,25 @@ public:
   atInt32 blockSize() const;
   void setMinimumOffset(atUint32 minimumOffset);
   atUint32 minimumOffset() const;
+  void setMaxChainDepth(atInt32 maxChainDepth);
+  atInt32 maxChainDepth() const;
+  // 0 takes the longest match at every position. 1 to MaxParseEffort choose the matches that encode
+  // smallest overall, pricing more of the shorter lengths at each position the higher the effort.
+  void setParseEffort(atInt32 parseEffort);
+  atInt32 parseEffort() const;
 
 protected:
   LZLengthOffset search(const atUint8* posPtr, const atUint8* dataBegin, const atUint8* dataEnd) const;
+  // Encoded size in bits of a match of the given length, its flag bit included
+  virtual atUint32 matchCost(atUint32 length) const = 0;
+  // Picks the matches for src ahead of encoding it, when a parse effort is set
+  void parseOptimal(const atUint8* src, atUint32 srcLength);
+  // The match to encode at posPtr, a length below the minimum match means a literal
+  LZLengthOffset nextMatch(const atUint8* posPtr, const atUint8* dataBegin, const atUint8* dataEnd);
+  // Allocates the output for the legacy decompress and fills it with decompressInto
+  atUint32 decompressAllocated(const atUint8* src, atUint8** dst, atUint32 srcLength) const;
+  // Copies a match of len bytes from dist bytes back, writing whole chunks when limit leaves room for them
+  static void copyMatch(atUint8* out, atUint32 dist, atUint32 len, const atUint8* limit);
 
   atInt32 m_slidingWindow;
   atInt32 m_readAheadBuffer;
@@ -31,4 +63,34 @@ protected:
   atInt32 m_blockSize;
   atUint32 m_minOffset;
   LZLookupTable m_lookupTable;
+  atInt32 m_parseEffort = 0;
+  std::vector<atUint32> m_parseLength; // Longest match at each position, then the length chosen there
+  std::vector<atUint16> m_parseOffset;
+  std::vector<atUint64> m_parseCost; // Fewest bits encoding everything from each position onward
 };
+
+inline void LZBase::copyMatch(atUint8* out, atUint32 dist, atUint32 len, const atUint8* limit) {
+  const atUint8* from = out - dist;
+  if (atUint64(limit - out) < atUint64(len) + 8) {
+    // Too close to the end of the buffer for whole chunks
+    for (atUint32 i = 0; i < len; ++i)
+      out[i] = from[i];
+    return;
+  }
+
+  if (dist >= 8) {
+    // Every chunk only reads bytes that are already written, even where the match overlaps itself
+    for (atUint32 i = 0; i < len; i += 8)
+      memcpy(out + i, from + i, 8);
+  } else if (dist == 1) {
+    memset(out, *from, len);
+  } else {
+    // Repeat the short pattern across a chunk, then step by a whole number of repeats
+    atUint8 pattern[8];
+    for (atUint32 i = 0; i < 8; ++i)
+      pattern[i] = from[i % dist];
+    const atUint32 step = 8 - 8 % dist;
+    for (atUint32 i = 0; i < len; i += step)
+      memcpy(out + i, pattern, 8);
+  }
+}
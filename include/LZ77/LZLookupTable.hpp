@@ -1,7 +1,6 @@
 #pragma once
 
 #include <cstdint>
-#include <map>
 #include <vector>
 #include <athena/Types.hpp>
 
@@ -12,6 +11,8 @@ struct LZLengthOffset {
   bool operator!=(const LZLengthOffset& lo_pair) const { return !operator==(lo_pair); }
 };
 
+/* Finds the longest earlier match for each position with a hash chain over the sliding window.
+ * Positions are linked newest first so ties resolve to the closest offset. */
 class LZLookupTable {
 public:
   LZLookupTable();
@@ -19,12 +20,23 @@ public:
   ~LZLookupTable();
   LZLengthOffset search(const atUint8* curPos, const atUint8* dataBegin, const atUint8* dataEnd);
   void setLookAheadWindow(atInt32 lookAheadWindow);
+  // Limits how many earlier positions each search examines, 0 examines the whole window
+  void setMaxChainDepth(atInt32 maxChainDepth);
+  atInt32 maxChainDepth() const { return m_maxChainDepth; }
+  // Forgets all positions, searching a new buffer does this automatically
+  void reset();
 
 private:
-  using LookupTable = std::multimap<std::vector<uint8_t>, int32_t>;
-  LookupTable table;
+  static constexpr atUint32 HashBits = 15;
+  atUint32 hash(const atUint8* pos) const;
+
+  std::vector<atInt32> m_head;  // Newest position for each hash
+  std::vector<atInt32> m_chain; // Previous position with the same hash, indexed by position & m_chainMask
+  atUint32 m_chainMask = 0;
+  const atUint8* m_dataBegin = nullptr;
+  atInt32 m_insertPos = 0; // Next position to link into the chains
   atInt32 m_minimumMatch = 3;
   atInt32 m_slidingWindow = 4096;
   atInt32 m_lookAheadWindow = 18;
-  std::vector<uint8_t> m_buffer;
+  atInt32 m_maxChainDepth = 0;
 };
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <athena/Types.hpp>
+
+/* Counts how many leading bytes of str1 and str2 are equal, stopping at maxLength.
+ * Compares 32, 16 or 8 bytes at a time depending on what the CPU supports, which is checked once.
+ * Never reads past maxLength bytes of either string. */
+atInt32 lzMatchLength(const atUint8* str1, const atUint8* str2, atInt32 maxLength);
@@ -8,4 +8,9 @@ public:
                     atInt32 BlockSize = 8);
   atUint32 compress(const atUint8* src, atUint8** dstBuf, atUint32 srcLength) override;
   atUint32 decompress(const atUint8* src, atUint8** dst, atUint32 srcLen) override;
+  athena::io::Compression::Status decompressInto(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstCap,
+                                                 size_t& decompressedLen) const override;
+
+protected:
+  atUint32 matchCost(atUint32 length) const override;
 };
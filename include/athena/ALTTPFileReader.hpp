@@ -28,8 +28,9 @@ public:
   /*! \brief This constructor creates an instance from a file on disk.
    *
    * \param filename The file to create the stream from
+   * \param mapFile  Map the file instead of reading it into memory
    */
-  ALTTPFileReader(const std::string&);
+  ALTTPFileReader(const std::string&, bool mapFile = false);
 
   /*! \brief Reads the SRAM data from the buffer
    *
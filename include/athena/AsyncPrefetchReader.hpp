@@ -0,0 +1,85 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "athena/IStreamReader.hpp"
+#include "athena/Types.hpp"
+
+namespace athena::io {
+/*! \class AsyncPrefetchReader
+ *  \brief A Stream class that reads ahead of the consumer on a background thread
+ *
+ *  A worker thread fills a ring of aligned buffers from the wrapped source ahead of the
+ *  current position, overlapping I/O with whatever the consumer does with the data.
+ *  Seeking within the buffered window is free; seeking outside of it cancels the
+ *  outstanding prefetch and restarts it at the new position.
+ *
+ *  The source is owned by the worker thread and must not be used directly while wrapped.
+ *  \sa IStreamReader
+ */
+class AsyncPrefetchReader : public IStreamReader {
+public:
+  /*! \brief Wraps an existing source stream.
+   *
+   *   \param source      The stream to prefetch from
+   *   \param bufferSize  Size of each ring buffer
+   *   \param bufferCount Number of buffers in the ring
+   *   \param globalErr   Whether or not global errors are enabled.
+   */
+  explicit AsyncPrefetchReader(std::unique_ptr<IStreamReader>&& source, atUint32 bufferSize = (1024 * 1024),
+                               atUint32 bufferCount = 3, bool globalErr = true);
+
+  /*! \brief Opens a file on disk and prefetches from it.
+   *
+   *   \param filename    The file to open
+   *   \param bufferSize  Size of each ring buffer
+   *   \param bufferCount Number of buffers in the ring
+   *   \param globalErr   Whether or not global errors are enabled.
+   */
+  explicit AsyncPrefetchReader(std::string_view filename, atUint32 bufferSize = (1024 * 1024),
+                               atUint32 bufferCount = 3, bool globalErr = true);
+  ~AsyncPrefetchReader() override;
+
+  void seek(atInt64 pos, SeekOrigin origin = SeekOrigin::Current) override;
+  atUint64 position() const override { return m_position; }
+  atUint64 length() const override { return m_length; }
+  atUint64 readUBytesToBuf(void* buf, atUint64 len) override;
+
+private:
+  struct Slot {
+    atUint8* data;
+    atUint64 offset = 0;
+    atUint64 size = 0;
+  };
+
+  void start();
+  void restart(atUint64 offset);
+  void restartOutsideWindow();
+  void worker(atUint64 sourcePos);
+
+  std::unique_ptr<IStreamReader> m_source;
+  atUint8* m_storage = nullptr;
+  atUint32 m_bufferSize;
+  std::vector<Slot> m_slots;
+  atUint64 m_length = 0;
+  atUint64 m_position = 0;
+  bool m_globalErr;
+
+  /* Guarded by m_lock */
+  std::mutex m_lock;
+  std::condition_variable m_filledCv;
+  std::condition_variable m_emptyCv;
+  size_t m_head = 0;        /* first filled slot */
+  size_t m_count = 0;       /* filled slots from m_head */
+  atUint64 m_fillOffset = 0; /* source offset of the next slot to fill */
+  atUint64 m_generation = 0; /* bumped whenever the prefetch restarts */
+  bool m_sourceEnd = false;
+  bool m_running = true;
+  std::thread m_thread;
+};
+} // namespace athena::io
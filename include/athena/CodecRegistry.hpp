@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "athena/IStreamReader.hpp"
+#include "athena/IStreamWriter.hpp"
+#include "athena/Types.hpp"
+
+namespace athena::io::Compression {
+enum class CodecType { Zlib, Gzip, Yaz0, LZ10, LZ11, LZO, Custom };
+
+/*! \class Codec
+ *  \brief Common interface to a compression format
+ *
+ *  Codecs are stateless and may be used from several threads at once.
+ *  \sa CodecRegistry
+ */
+class Codec {
+public:
+  virtual ~Codec() = default;
+
+  virtual CodecType type() const = 0;
+  virtual std::string_view name() const = 0;
+
+  /*! \brief Range of levels accepted by compress, higher compresses better */
+  virtual atInt32 minLevel() const = 0;
+  virtual atInt32 maxLevel() const = 0;
+  virtual atInt32 defaultLevel() const = 0;
+
+  /*! \brief Whether src starts with this format's header */
+  virtual bool matches(const atUint8* src, size_t srcLen) const = 0;
+
+  /*! \brief Reads the decompressed size from the header, false if the format doesn't record it */
+  virtual bool peekSize(const atUint8* src, size_t srcLen, atUint64& size) const = 0;
+
+  /*! \brief Compresses src into dst, header included, returning false on failure */
+  virtual bool compress(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst, atInt32 level) const = 0;
+
+  /*! \brief Decompresses src, header included, into dst, returning false if the data is invalid */
+  virtual bool decompress(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst) const = 0;
+
+  /*! \brief Wraps source in a reader that decompresses it, or returns nullptr if the format can't be streamed */
+  virtual std::unique_ptr<IStreamReader> openReader(std::unique_ptr<IStreamReader>&& source) const;
+
+  /*! \brief Wraps destination in a writer that compresses into it, or returns nullptr if the format can't be streamed */
+  virtual std::unique_ptr<IStreamWriter> openWriter(std::unique_ptr<IStreamWriter>&& destination, atInt32 level) const;
+};
+
+/*! \class CodecRegistry
+ *  \brief Looks up codecs by type or name, or from the header of compressed data
+ *
+ *  Holds zlib, gzip, Yaz0, LZ10 and LZ11 to begin with, and LZO when lzokay is built in. LZO has
+ *  no header, so detect never returns it. Codecs added later must be added before the registry
+ *  is used from more than one thread.
+ */
+class CodecRegistry {
+public:
+  static CodecRegistry& instance();
+
+  void add(std::unique_ptr<Codec>&& codec);
+  const std::vector<std::unique_ptr<Codec>>& codecs() const { return m_codecs; }
+
+  const Codec* find(CodecType type) const;
+  const Codec* find(std::string_view name) const;
+
+  /*! \brief Finds the codec whose header src starts with, or nullptr
+   *
+   *  Formats with a distinct magic are checked before the LZ77 types, whose single type byte
+   *  is only a weak hint.
+   */
+  const Codec* detect(const atUint8* src, size_t srcLen) const;
+
+private:
+  CodecRegistry();
+
+  std::vector<std::unique_ptr<Codec>> m_codecs;
+};
+
+inline const Codec* detect(const atUint8* src, size_t srcLen) { return CodecRegistry::instance().detect(src, srcLen); }
+
+/*! \brief Decompresses src with whichever codec its header names, returning false if none matches */
+bool autoDecompress(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst);
+
+struct AutoCompressResult {
+  const Codec* codec = nullptr;
+  std::vector<atUint8> data;
+};
+
+/*! \brief Compresses src with every registered codec at its default level and keeps the smallest
+ *
+ *  Each codec is first timed on a sample of src; codecs expected to exceed the budget are skipped,
+ *  except that the fastest always runs. The rest compress in parallel.
+ *
+ *   \param src     The data to compress
+ *   \param srcLen  Length of src
+ *   \param budget  Roughly how long compressing may take
+ *   \param threads Number of threads to compress on, 0 uses one per hardware thread
+ *   \return The winning codec and its output, codec is nullptr if nothing could compress src
+ */
+AutoCompressResult autoCompress(const atUint8* src, size_t srcLen,
+                                std::chrono::milliseconds budget = std::chrono::milliseconds(1000),
+                                atUint32 threads = 0);
+} // namespace athena::io::Compression
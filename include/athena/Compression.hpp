@@ -1,21 +1,242 @@
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "athena/Types.hpp"
+#include "LZ77/LZLookupTable.hpp"
+#include "LZ77/LZType10.hpp"
+#include "LZ77/LZType11.hpp"
+
+struct z_stream_s;
 
 namespace athena::io::Compression {
+/*! \brief Outcome of the size_t based codec functions */
+enum class Status {
+  Ok,              //!< Completed successfully
+  TruncatedInput,  //!< src ended before the compressed data did
+  OutputOverrun,   //!< dst is too small for the result
+  InvalidData,     //!< src is corrupt or not in the expected format
+  InvalidArgument, //!< A level is out of range, or a length is larger than the format can describe
+  Unsupported,     //!< The codec was not built into this library
+  Error            //!< Any other failure, such as running out of memory
+};
+
 // Zlib compression
+constexpr atInt32 ZlibBestCompression = 9;
+
+/*! \brief Reusable zlib deflate state
+ *
+ *  Setting up deflate allocates a few hundred KiB, a compressor keeps that state between
+ *  calls and only resets it; changing the level sets it up again. Not safe to share between threads.
+ */
+class ZlibCompressor {
+public:
+  /*! \param level      Compression level from 0 to 9, or -1 for zlib's default
+   *  \param windowBits Window size and format, 8 to 15 for zlib data, plus 16 for gzip data
+   */
+  explicit ZlibCompressor(atInt32 level = ZlibBestCompression, atInt32 windowBits = 15);
+  ~ZlibCompressor();
+  ZlibCompressor(const ZlibCompressor&) = delete;
+  ZlibCompressor& operator=(const ZlibCompressor&) = delete;
+
+  void setLevel(atInt32 level);
+  atInt32 level() const { return m_level; }
+
+  /*! \brief Compresses src into a complete zlib or gzip stream
+   *
+   *   \return The compressed length, or a zlib error code if dst is too small or the data can't be compressed
+   */
+  atInt32 compress(const atUint8* src, atUint32 srcLen, atUint8* dst, atUint32 dstLen);
+  Status compress(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& compressedLen);
+
+private:
+  std::unique_ptr<z_stream_s> m_stream;
+  atInt32 m_level;
+  atInt32 m_windowBits;
+  atInt32 m_initResult;
+};
+
+/*! \brief Reusable zlib inflate state, accepts zlib and gzip data
+ *
+ *  Not safe to share between threads.
+ */
+class ZlibDecompressor {
+public:
+  ZlibDecompressor();
+  ~ZlibDecompressor();
+  ZlibDecompressor(const ZlibDecompressor&) = delete;
+  ZlibDecompressor& operator=(const ZlibDecompressor&) = delete;
+
+  /*! \brief Decompresses a complete zlib or gzip stream
+   *
+   *   \return The decompressed length, or a zlib error code if the data is invalid or dst is too small
+   */
+  atInt32 decompress(const atUint8* src, atUint32 srcLen, atUint8* dst, atUint32 dstLen);
+  Status decompress(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& decompressedLen);
+
+private:
+  std::unique_ptr<z_stream_s> m_stream;
+  atInt32 m_initResult;
+};
+
+// These use a compressor or decompressor private to the calling thread
 atInt32 decompressZlib(const atUint8* src, atUint32 srcLen, atUint8* dst, atUint32 dstLen);
-atInt32 compressZlib(const atUint8* src, atUint32 srcLen, atUint8* dst, atUint32 dstLen);
+atInt32 compressZlib(const atUint8* src, atUint32 srcLen, atUint8* dst, atUint32 dstLen,
+                     atInt32 level = ZlibBestCompression);
+Status decompressZlib(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& decompressedLen);
+Status compressZlib(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& compressedLen,
+                    atInt32 level = ZlibBestCompression);
+
+/*! \brief Compresses large buffers on several threads at once
+ *
+ *  The input is split into blocks that are deflated concurrently, each primed with the 32 KiB
+ *  before it so matches still reach across block boundaries. The blocks are joined into a
+ *  single standard stream that decompressZlib, or any other inflater, reads as usual.
+ *
+ *   \param src     The data to compress
+ *   \param srcLen  Length of src
+ *   \param dst     Receives a new[] allocated buffer holding the compressed stream
+ *   \param level   Compression level from 0 to 9, or -1 for zlib's default
+ *   \param threads Number of threads to compress on, 0 uses one per hardware thread
+ *   \param gzip    Whether to write a gzip stream instead of a zlib stream
+ *   \return The compressed length, or 0 if the data could not be compressed
+ */
+atUint64 compressZlibParallel(const atUint8* src, atUint64 srcLen, atUint8** dst, atInt32 level = ZlibBestCompression,
+                              atUint32 threads = 0, bool gzip = false);
 
-#if AT_LZOKAY
 // lzo compression
+#if AT_LZOKAY
 atInt32 decompressLZO(const atUint8* source, atInt32 sourceSize, atUint8* dst, atInt32& dstSize);
 #endif
 
+/*! \brief Reusable LZO1X compressor
+ *
+ *  The match dictionary is over 100 KiB, a compressor keeps it between calls.
+ *  Without lzokay built in every call returns Status::Unsupported. Not safe to share between threads.
+ */
+class LZOCompressor {
+public:
+  LZOCompressor();
+  ~LZOCompressor();
+  LZOCompressor(const LZOCompressor&) = delete;
+  LZOCompressor& operator=(const LZOCompressor&) = delete;
+
+  /*! \brief Compresses src, dst should hold at least maxCompressedSize(srcLen) bytes */
+  Status compress(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& compressedLen);
+
+  /*! \brief Worst case compressed length */
+  static constexpr size_t maxCompressedSize(size_t srcLen) { return srcLen + srcLen / 16 + 64 + 3; }
+
+private:
+  struct Dictionary;
+  std::unique_ptr<Dictionary> m_dict;
+};
+
+// These use a compressor private to the calling thread, or return Status::Unsupported without lzokay
+Status compressLZO(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& compressedLen);
+Status decompressLZO(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& decompressedLen);
+
 // Yaz0 encoding
+constexpr atUint32 Yaz0HeaderSize = 0x10;
+
+/*! \brief Reads the decompressed size from a Yaz0 header
+ *
+ *   \param src              The data starting with the header
+ *   \param srcLen           Length of src
+ *   \param uncompressedSize Receives the decompressed size
+ *   \return TruncatedInput if src is shorter than a header, InvalidData if it isn't a Yaz0 header
+ */
+Status yaz0PeekHeader(const atUint8* src, size_t srcLen, atUint64& uncompressedSize);
+
+/*! \brief Decodes a Yaz0 stream, never reading or writing outside the given buffers
+ *
+ *   \param src        The encoded data following the header
+ *   \param srcLen     Length of src
+ *   \param dst        Receives the decoded data
+ *   \param dstLen     The decompressed size, as stored in the header
+ *   \param decodedLen Receives how many bytes were decoded
+ *   \return InvalidData for a back-reference before the start of dst, OutputOverrun for one past its end
+ */
+Status yaz0Decode(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& decodedLen);
 atUint32 yaz0Decode(const atUint8* src, atUint8* dst, atUint32 uncompressedSize);
 atUint32 yaz0Encode(const atUint8* src, atUint32 srcSize, atUint8* data);
+Status yaz0Encode(const atUint8* src, size_t srcSize, atUint8* dst, size_t dstLen, size_t& encodedLen);
+
+/*! \brief Reusable Yaz0 encoder
+ *
+ *  Matches are found with a hash chain over the 4 KiB window. All state lives in the
+ *  object, so separate encoders can run on different threads at once; reusing one
+ *  encoder for many buffers also reuses its tables.
+ */
+class Yaz0Encoder {
+public:
+  enum class Level {
+    Fast,     //!< Greedy matching over a bounded chain depth
+    Nintendo, //!< Greedy with one byte lookahead, as the official encoder does
+    Optimal   //!< Chooses literals and match lengths by cost over the whole input
+  };
+
+  explicit Yaz0Encoder(Level level = Level::Nintendo);
+
+  void setLevel(Level level);
+  Level level() const { return m_level; }
+
+  /*! \brief Encodes src without a Yaz0 header
+   *
+   *   \param src     The data to encode
+   *   \param srcSize Length of src
+   *   \param dst     Receives the encoded data, must hold at least maxEncodedSize(srcSize) bytes
+   *   \return The encoded length
+   */
+  atUint32 encode(const atUint8* src, atUint32 srcSize, atUint8* dst);
+  Status encode(const atUint8* src, size_t srcSize, atUint8* dst, size_t dstLen, size_t& encodedLen);
+
+  /*! \brief Worst case encoded length, every byte a literal plus one code byte per eight */
+  static constexpr atUint32 maxEncodedSize(atUint32 srcSize) { return srcSize + (srcSize + 7) / 8; }
+
+private:
+  void parseOptimal(const atUint8* src, atUint32 srcSize);
+
+  Level m_level;
+  LZLookupTable m_table;
+  std::vector<atUint16> m_matchLength; // Optimal parse only: chosen token length per position, 1 for literals
+  std::vector<atUint16> m_matchOffset;
+  std::vector<atUint32> m_cost;
+};
+
+/*! \brief Reusable LZ77 type 0x10 and 0x11 coders
+ *
+ *  Keeps both coders and their match tables alive between calls. Not safe to share between threads.
+ */
+class LZ77Codec {
+public:
+  LZ77Codec();
+
+  /*! \brief Limits how many earlier positions each match search examines, 0 examines the whole window */
+  void setMaxChainDepth(atInt32 maxChainDepth);
+  atInt32 maxChainDepth() const { return m_type10.maxChainDepth(); }
+
+  /*! \brief 0 encodes the longest match everywhere, up to LZBase::MaxParseEffort picks matches by encoded size */
+  void setParseEffort(atInt32 parseEffort);
+  atInt32 parseEffort() const { return m_type10.parseEffort(); }
+
+  atUint32 decompress(const atUint8* src, atUint32 srcLen, atUint8** dst);
+  atUint32 compress(const atUint8* src, atUint32 srcLen, atUint8** dst, bool extended = false);
+  /*! \brief Decompresses into a caller provided buffer, which needs room for the size the header records */
+  Status decompress(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& decompressedLen);
+  Status decompress(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst);
+  Status compress(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst, bool extended = false);
+
+private:
+  LZType10 m_type10;
+  LZType11 m_type11;
+};
 
+// These use a codec private to the calling thread
 atUint32 decompressLZ77(const atUint8* src, atUint32 srcLen, atUint8** dst);
 atUint32 compressLZ77(const atUint8* src, atUint32 srcLen, atUint8** dst, bool extended = false);
+Status decompressLZ77(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& decompressedLen);
+Status decompressLZ77(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst);
+Status compressLZ77(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst, bool extended = false);
 } // namespace athena::io::Compression
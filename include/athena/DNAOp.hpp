@@ -338,10 +338,16 @@ struct Read {
   static std::enable_if_t<!std::is_same_v<T, bool>> Do(const PropId& id, std::vector<T>& vector, const S& count,
                                                        StreamT& r) {
     vector.clear();
-    vector.reserve(count);
-    for (size_t i = 0; i < static_cast<size_t>(count); ++i) {
-      vector.emplace_back();
-      Read<PropOp>::Do<T, DNAE>(id, vector.back(), r);
+    if constexpr (std::is_arithmetic_v<T> || VecTraits<T>::IsVec) {
+      /* Plain values are read and byte swapped in bulk */
+      vector.resize(static_cast<size_t>(count));
+      r.readArray<T, DNAE>(vector.data(), vector.size());
+    } else {
+      vector.reserve(count);
+      for (size_t i = 0; i < static_cast<size_t>(count); ++i) {
+        vector.emplace_back();
+        Read<PropOp>::Do<T, DNAE>(id, vector.back(), r);
+      }
     }
   }
   template <class T, class S, Endian DNAE>
@@ -493,8 +499,13 @@ struct Write {
   template <class T, class S, Endian DNAE>
   static std::enable_if_t<!std::is_same_v<T, bool>> Do(const PropId& id, std::vector<T>& vector, const S& count,
                                                        StreamT& w) {
-    for (T& v : vector)
-      Write<PropOp>::Do<T, DNAE>(id, v, w);
+    if constexpr (PropOp == PropType::None && (std::is_arithmetic_v<T> || VecTraits<T>::IsVec)) {
+      /* Plain values are byte swapped and written in bulk */
+      w.writeArray<T, DNAE>(vector.data(), vector.size());
+    } else {
+      for (T& v : vector)
+        Write<PropOp>::Do<T, DNAE>(id, v, w);
+    }
   }
   template <class T, class S, Endian DNAE>
   static std::enable_if_t<std::is_same_v<T, bool>> Do(const PropId& id, std::vector<T>& vector, const S& count,
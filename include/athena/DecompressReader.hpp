@@ -0,0 +1,160 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "athena/IStreamReader.hpp"
+#include "athena/Types.hpp"
+
+namespace athena::io {
+/*! \class DecompressReader
+ *  \brief Base for Stream classes that decompress another stream as it is read
+ *
+ *  Output is decoded a chunk at a time into a sliding buffer that keeps just enough
+ *  history for back-references, so memory use stays bounded whatever the size of the
+ *  decompressed data. Decoded bytes are exposed through the inline read window.
+ *
+ *  Formats that do not record their decompressed length report UnknownLength until
+ *  decoding reaches the end of the data.
+ *
+ *  Seeking forward decodes and skips; seeking back within the buffer is free, anything
+ *  further back restarts decoding from the start of the compressed data.
+ *  The source is owned by the reader and must not be used directly while wrapped.
+ *  \sa Yaz0Reader
+ *  \sa LZ77Reader
+ */
+class DecompressReader : public IStreamReader {
+public:
+  static constexpr atUint64 UnknownLength = ~atUint64(0);
+
+  ~DecompressReader() override;
+
+  void seek(atInt64 pos, SeekOrigin origin = SeekOrigin::Current) override;
+  atUint64 position() const override { return m_bufferOffset + atUint64(m_cur - m_buffer.data()); }
+  atUint64 length() const override { return m_length; }
+  atUint64 readUBytesToBuf(void* buf, atUint64 len) override;
+
+protected:
+  /*! \brief Wraps an existing source stream positioned at the compressed data's header.
+   *
+   *   \param source      The stream holding the compressed data
+   *   \param historySize How far back-references may reach
+   *   \param maxRun      The longest run a single token can produce
+   *   \param globalErr   Whether or not global errors are enabled.
+   */
+  DecompressReader(std::unique_ptr<IStreamReader>&& source, atUint32 historySize, atUint32 maxRun, bool globalErr);
+
+  /*! \brief Reads the header; derived constructors call this once they are set up */
+  void start();
+
+  /*! \brief Reads the format's header and resets the decoder state
+   *
+   *   \param length Receives the decompressed length, or UnknownLength
+   *   \return False if the header is not valid
+   */
+  virtual bool readHeader(atUint64& length) = 0;
+
+  /*! \brief Decodes whole tokens into the buffer
+   *
+   *   Decoding stops once out reaches limit; no token may write past end.
+   *   Returning out unchanged marks the end of data of unknown length.
+   *   \return Where decoding stopped, or nullptr if the data is corrupt or truncated
+   */
+  virtual atUint8* decode(atUint8* out, atUint8* limit, atUint8* end) = 0;
+
+  /*! \brief Returns the buffered compressed bytes, refilling from the source when empty
+   *
+   *   \return False at the end of the source
+   */
+  bool peekInput(const atUint8*& data, size_t& len) {
+    if (m_inCur == m_inEnd && !fillInput())
+      return false;
+    data = m_inCur;
+    len = size_t(m_inEnd - m_inCur);
+    return true;
+  }
+
+  /*! \brief Consumes len bytes returned by peekInput */
+  void consumeInput(size_t len) { m_inCur += len; }
+
+  /*! \brief Fetches the next compressed byte, returning false at the end of the source */
+  bool nextByte(atUint8& val) {
+    if (m_inCur == m_inEnd && !fillInput())
+      return false;
+    val = *m_inCur++;
+    return true;
+  }
+
+  /*! \brief Copies a back-reference, returning false if it reaches before the decoded history */
+  bool copyMatch(atUint8* out, atUint32 dist, atUint32 len) const;
+
+  bool underflow(atUint64 len) override { return refill(len); }
+
+private:
+  bool fillInput();
+  bool refill(atUint64 len);
+  bool rewind();
+
+  std::unique_ptr<IStreamReader> m_source;
+  atUint64 m_sourceStart = 0;
+  std::vector<atUint8> m_input;
+  const atUint8* m_inCur = nullptr;
+  const atUint8* m_inEnd = nullptr;
+  std::vector<atUint8> m_buffer;
+  atUint64 m_bufferOffset = 0; /* decompressed offset of m_buffer[0] */
+  atUint32 m_historySize;
+  atUint32 m_maxRun;
+  atUint64 m_length = 0;
+  bool m_globalErr;
+};
+
+/*! \class Yaz0Reader
+ *  \brief A Stream class that decompresses a Yaz0 stream as it is read
+ *  \sa DecompressReader
+ */
+class Yaz0Reader : public DecompressReader {
+public:
+  /*! \brief Wraps an existing source stream positioned at a Yaz0 header.
+   *
+   *   \param source    The stream holding the compressed data
+   *   \param globalErr Whether or not global errors are enabled.
+   */
+  explicit Yaz0Reader(std::unique_ptr<IStreamReader>&& source, bool globalErr = true);
+
+protected:
+  bool readHeader(atUint64& length) override;
+  atUint8* decode(atUint8* out, atUint8* limit, atUint8* end) override;
+
+private:
+  atUint8 m_code = 0;
+  atUint32 m_bits = 0;
+};
+
+/*! \class LZ77Reader
+ *  \brief A Stream class that decompresses an LZ77 type 0x10 or 0x11 stream as it is read
+ *  \sa DecompressReader
+ *  \sa LZType10
+ *  \sa LZType11
+ */
+class LZ77Reader : public DecompressReader {
+public:
+  /*! \brief Wraps an existing source stream positioned at an LZ77 header.
+   *
+   *   \param source    The stream holding the compressed data
+   *   \param globalErr Whether or not global errors are enabled.
+   */
+  explicit LZ77Reader(std::unique_ptr<IStreamReader>&& source, bool globalErr = true);
+
+  /*! \brief Whether the stream uses the extended 0x11 encoding */
+  bool isExtended() const { return m_extended; }
+
+protected:
+  bool readHeader(atUint64& length) override;
+  atUint8* decode(atUint8* out, atUint8* limit, atUint8* end) override;
+
+private:
+  bool m_extended = false;
+  atUint8 m_flags = 0;
+  atUint32 m_bits = 0;
+};
+} // namespace athena::io
@@ -11,6 +11,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "athena/IStreamReader.hpp"
 #include "athena/Types.hpp"
@@ -47,8 +48,29 @@ public:
   atUint64 length() const override;
   atUint64 readUBytesToBuf(void* buf, atUint64 len) override;
 
+  /*! \brief Sets the size of each cache block; 0 or less disables caching */
   void setCacheSize(const atInt32 blockSize);
 
+  /*! \brief Sets how many blocks the cache holds; the least recently used block is evicted first */
+  void setCacheBlockCount(const atInt32 blockCount);
+
+  /*! \brief Sets how many blocks are prefetched when a miss follows sequential access */
+  void setReadaheadBlocks(const atInt32 readahead) { m_readahead = readahead < 0 ? 0 : readahead; }
+
+  /*! \brief Re-queries the file length from the open handle.
+   *
+   *  The length is captured when the file is opened; call this if the file may have
+   *  grown or shrunk since. Cached blocks are discarded.
+   */
+  void refreshLength();
+
+  atUint64 cacheHits() const { return m_cacheHits; }
+  atUint64 cacheMisses() const { return m_cacheMisses; }
+  void resetCacheStats() {
+    m_cacheHits = 0;
+    m_cacheMisses = 0;
+  }
+
 #if _WIN32
   using HandleType = HANDLE;
 #else
@@ -58,16 +80,46 @@ public:
   HandleType _fileHandle() { return m_fileHandle; }
 
 protected:
+  struct CacheBlock {
+    std::unique_ptr<atUint8[]> data;
+    atInt64 index = -1;
+    atUint64 size = 0;
+    atUint64 lastUse = 0;
+  };
+
+  /* Generic cache front-end (FileReaderGeneric.cpp) */
+  void seekCached(atInt64 pos, SeekOrigin origin);
+  atUint64 readCached(void* buf, atUint64 len);
+  const CacheBlock& cacheBlock(atUint64 index);
+  void resetCache();
+  bool underflow(atUint64 len) override;
+
+  /* Folds the unread part of the inline window back into m_offset and drops it */
+  void syncWindow() {
+    m_offset -= atUint64(m_end - m_cur);
+    m_cur = m_end = nullptr;
+  }
+
+  /* Platform back-end; reads at an absolute offset without touching m_offset */
+  atUint64 readAt(atUint64 offset, void* buf, atUint64 len);
+
 #if _WIN32
   std::wstring m_filename;
 #else
   std::string m_filename;
 #endif
   HandleType m_fileHandle;
-  std::unique_ptr<atUint8[]> m_cacheData;
-  atInt32 m_blockSize;
-  atInt32 m_curBlock;
-  atUint64 m_offset;
+  std::vector<CacheBlock> m_cacheBlocks;
+  atInt32 m_blockSize = 0;
+  atInt32 m_blockCount = 4;
+  atInt32 m_readahead = 1;
+  atInt64 m_lastBlock = -1;
+  atUint64 m_useCounter = 0;
+  atUint64 m_cacheHits = 0;
+  atUint64 m_cacheMisses = 0;
+  atUint64 m_offset; /* while a window is open, the offset of m_end */
+  atUint64 m_length = 0;
+  atUint64 m_handleOffset = 0;
   bool m_globalErr;
 };
 } // namespace athena::io
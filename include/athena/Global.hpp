@@ -54,15 +54,19 @@
 #include "gekko_support.h"
 typedef struct stat atStat64_t;
 #define atStat64 stat
+#define atFStat64 fstat
 #elif _WIN32
 typedef struct _stat64 atStat64_t;
 #define atStat64 _stat64
+#define atFStat64 _fstat64
 #elif __APPLE__ || __FreeBSD__
 typedef struct stat atStat64_t;
 #define atStat64 stat
+#define atFStat64 fstat
 #else
 typedef struct stat64 atStat64_t;
 #define atStat64 stat64
+#define atFStat64 fstat64
 #endif
 
 #ifndef BLOCKSZ
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "athena/Types.hpp"
+
+namespace athena::io {
+/*! \class IORing
+ *  \brief A batched asynchronous I/O queue backed by io_uring on Linux
+ *
+ *  Reads and writes are queued against file descriptors and handed to the kernel in
+ *  one system call by submit(), which also collects completions. Buffers registered
+ *  with registerBuffers() are pinned once by the kernel instead of on every request.
+ *
+ *  When io_uring is unavailable (older kernels, seccomp filters, non-Linux systems) the
+ *  ring falls back to running queued requests with blocking system calls inside submit(),
+ *  so callers never need a separate code path.
+ */
+class IORing {
+public:
+  /*! \brief Completion callback; result is the byte count or a negated errno */
+  using Completion = std::function<void(atUint64 userData, atInt64 result)>;
+
+  struct Buffer {
+    void* data;
+    atUint64 size;
+  };
+
+  /*! \brief One file of a bulk read; see readFiles() */
+  struct FileRead {
+    std::string path;
+    void* buf = nullptr;
+    atUint64 len = 0;
+    atUint64 offset = 0;
+    atInt64 result = 0; /* bytes read, or a negated errno */
+  };
+
+  /*! \brief Sets up a ring.
+   *
+   *   \param entries  Submission queue depth
+   *   \param fallback Force the blocking fallback even if io_uring is available
+   */
+  explicit IORing(atUint32 entries = 64, bool fallback = false);
+  ~IORing();
+  IORing(const IORing&) = delete;
+  IORing& operator=(const IORing&) = delete;
+
+  /*! \brief Whether requests go through io_uring rather than the blocking fallback */
+  bool isAsync() const { return m_ringFd >= 0; }
+  atUint32 entries() const { return m_entries; }
+
+  /*! \brief Requests queued but not yet handed to the kernel */
+  atUint32 queued() const;
+
+  /*! \brief Requests submitted whose completions have not been collected yet */
+  atUint32 inFlight() const { return m_inFlight; }
+
+  /*! \brief Registers buffers for use with the bufIndex argument of queueRead/queueWrite.
+   *
+   *   Any previously registered set is replaced. Returns false if the kernel refused them,
+   *   in which case requests naming a buffer index still work, only without the fixed mapping.
+   */
+  bool registerBuffers(const std::vector<Buffer>& buffers);
+  void unregisterBuffers();
+
+  /*! \brief Queues a read of len bytes at offset.
+   *
+   *   Returns false if the queue is full; submit() to make room.
+   *   \param bufIndex Index of the registered buffer containing buf, or -1
+   */
+  bool queueRead(int fd, void* buf, atUint32 len, atUint64 offset, atUint64 userData, atInt32 bufIndex = -1);
+
+  /*! \brief Queues a write of len bytes at offset; see queueRead() */
+  bool queueWrite(int fd, const void* buf, atUint32 len, atUint64 offset, atUint64 userData,
+                  atInt32 bufIndex = -1);
+
+  /*! \brief Submits all queued requests and waits until at least waitFor of the in-flight
+   *   requests have completed. Every completion collected is passed to onComplete.
+   *
+   *   \return Number of completions collected
+   */
+  atUint32 submit(atUint32 waitFor, const Completion& onComplete);
+
+  /*! \brief Submits everything and waits for every in-flight request */
+  void waitAll(const Completion& onComplete) { submit(queued() + inFlight(), onComplete); }
+
+  /*! \brief Opens, reads and closes many files with a handful of system calls.
+   *
+   *   Each entry reads up to len bytes at offset of path into buf; result receives the
+   *   number of bytes read, or a negated errno on failure. The opens, reads and closes of
+   *   each queue's worth of files are each submitted as one batch.
+   *   Must not be called while other requests are queued or in flight.
+   */
+  void readFiles(std::vector<FileRead>& reads);
+
+private:
+  enum class Op { Read, Write, Open, Close };
+
+  struct Request {
+    Op op;
+    int fd;
+    void* buf;
+    atUint32 len;
+    atUint64 offset;
+    atUint64 userData;
+  };
+
+  void setup();
+  void teardown();
+  bool queue(const Request& req, atInt32 bufIndex);
+  atUint32 reap(const Completion& onComplete);
+  static atInt64 runBlocking(const Request& req);
+
+  atUint32 m_entries;
+  int m_ringFd = -1;
+  atUint32 m_inFlight = 0;
+  bool m_buffersRegistered = false;
+
+  /* Kernel ring mappings */
+  void* m_sqRing = nullptr;
+  void* m_cqRing = nullptr;
+  void* m_sqes = nullptr;
+  atUint64 m_sqRingSize = 0;
+  atUint64 m_cqRingSize = 0;
+  atUint64 m_sqesSize = 0;
+  atUint32* m_sqHead = nullptr;
+  atUint32* m_sqTail = nullptr;
+  atUint32* m_sqArray = nullptr;
+  atUint32 m_sqMask = 0;
+  atUint32* m_cqHead = nullptr;
+  atUint32* m_cqTail = nullptr;
+  atUint32 m_cqMask = 0;
+  void* m_cqes = nullptr;
+  atUint32 m_toSubmit = 0;
+
+  /* Blocking fallback */
+  std::vector<Request> m_pending;
+};
+} // namespace athena::io
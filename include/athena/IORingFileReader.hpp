@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "athena/IORing.hpp"
+#include "athena/IStreamReader.hpp"
+#include "athena/Types.hpp"
+
+namespace athena::io {
+/*! \class IORingFileReader
+ *  \brief A block cached file reader that fetches through an IORing
+ *
+ *  Behaves like FileReader, but cache blocks are filled through an IORing over registered
+ *  buffers. When reading sequentially, the blocks ahead of the current one are submitted in
+ *  one batch and land in the cache while the caller works on the current block.
+ *  Without io_uring the blocks are read with pread instead.
+ *  \sa FileReader
+ *  \sa IORing
+ */
+class IORingFileReader : public IStreamReader {
+public:
+  /*! \brief Opens a file for reading.
+   *
+   *   \param filename   The file to open
+   *   \param blockSize  Size of each cache block
+   *   \param blockCount Number of cache blocks
+   *   \param globalErr  Whether or not global errors are enabled.
+   */
+  explicit IORingFileReader(std::string_view filename, atInt32 blockSize = (32 * 1024), atInt32 blockCount = 8,
+                            bool globalErr = true);
+  ~IORingFileReader() override;
+
+  std::string filename() const { return m_filename; }
+  bool isOpen() const { return m_fd >= 0; }
+  void close();
+
+  /*! \brief Whether blocks are fetched through io_uring */
+  bool isAsync() const { return m_ring.isAsync(); }
+
+  /*! \brief Sets how many blocks are fetched ahead of a sequential reader; 0 disables it */
+  void setReadaheadBlocks(atInt32 blocks);
+
+  void seek(atInt64 pos, SeekOrigin origin = SeekOrigin::Current) override;
+  atUint64 position() const override { return m_offset; }
+  atUint64 length() const override { return m_length; }
+  atUint64 readUBytesToBuf(void* buf, atUint64 len) override;
+
+  atUint64 cacheHits() const { return m_cacheHits; }
+  atUint64 cacheMisses() const { return m_cacheMisses; }
+
+private:
+  struct Block {
+    atUint8* data;
+    atInt64 index = -1;
+    atUint64 size = 0;
+    atUint64 lastUse = 0;
+    bool loading = false;
+  };
+
+  const Block& block(atUint64 index);
+  Block* victim(const Block* keep);
+  void fetch(Block& block, atUint64 index);
+  void prefetch(atUint64 first, const Block* keep);
+  void complete(atUint64 userData, atInt64 result);
+  void wait(const Block& block);
+  atUint64 readDirect(void* buf, atUint64 len);
+
+  std::string m_filename;
+  int m_fd = -1;
+  IORing m_ring;
+  atUint8* m_storage = nullptr;
+  atUint32 m_blockSize;
+  std::vector<Block> m_blocks;
+  atInt32 m_readahead;
+  atInt64 m_lastBlock = -1;
+  atUint64 m_useCounter = 0;
+  atUint64 m_cacheHits = 0;
+  atUint64 m_cacheMisses = 0;
+  atUint64 m_direct = 0;
+  bool m_directError = false;
+  atUint64 m_length = 0;
+  atUint64 m_offset = 0;
+  bool m_globalErr;
+};
+} // namespace athena::io
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "athena/IORing.hpp"
+#include "athena/IStreamWriter.hpp"
+#include "athena/Types.hpp"
+
+namespace athena::io {
+/*! \class IORingFileWriter
+ *  \brief A file writer that queues filled chunks to an IORing
+ *
+ *  Writes are gathered into a ring of registered chunk buffers. Each full chunk is handed
+ *  to the kernel as soon as it fills and written while the caller fills the next one, so
+ *  writing only blocks once every chunk is in flight. Without io_uring each chunk is
+ *  written with pwrite instead.
+ *
+ *  Like FileWriter, overwriting writes to a temporary file that replaces the original on close().
+ *  \sa FileWriter
+ *  \sa IORing
+ */
+class IORingFileWriter : public IStreamWriter {
+public:
+  /*! \brief Opens a file for writing.
+   *
+   *   \param filename   The file to open
+   *   \param overwrite  Whether to replace the file rather than write into it
+   *   \param chunkSize  Size of each chunk buffer
+   *   \param chunkCount Number of chunk buffers
+   *   \param globalErr  Whether or not global errors are enabled.
+   */
+  explicit IORingFileWriter(std::string_view filename, bool overwrite = true, atUint32 chunkSize = (256 * 1024),
+                            atUint32 chunkCount = 4, bool globalErr = true);
+  ~IORingFileWriter() override;
+
+  std::string filename() const { return m_filename; }
+  void open(bool overwrite = true);
+  void close();
+  bool isOpen() const { return m_fd >= 0; }
+
+  /*! \brief Whether chunks are written through io_uring */
+  bool isAsync() const { return m_ring.isAsync(); }
+
+  /*! \brief Writes out the partially filled chunk and waits for every chunk in flight */
+  void flush();
+
+  void seek(atInt64 pos, SeekOrigin origin = SeekOrigin::Current) override;
+  atUint64 position() const override { return m_position; }
+  atUint64 length() const override { return m_length; }
+  void writeUBytes(const atUint8* data, atUint64 len) override;
+
+private:
+  struct Chunk {
+    atUint8* data;
+    atUint64 offset = 0;
+    atUint32 used = 0;
+    bool inFlight = false;
+  };
+
+  void issue(Chunk& chunk);
+  void complete(atUint64 userData, atInt64 result);
+  void wait(const Chunk& chunk);
+
+  std::string m_filename;
+  int m_fd = -1;
+  bool m_overwrite = true;
+  IORing m_ring;
+  atUint8* m_storage = nullptr;
+  atUint32 m_chunkSize;
+  std::vector<Chunk> m_chunks;
+  size_t m_current = 0;
+  atUint64 m_position = 0;
+  atUint64 m_length = 0;
+  bool m_globalErr;
+};
+} // namespace athena::io
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <type_traits>
@@ -9,11 +11,27 @@
 #include "athena/Utility.hpp"
 
 namespace athena::io {
+/** @brief A read-only run of bytes returned by IStreamReader::readView and IStreamReader::peekView
+ */
+struct ByteView {
+  const atUint8* data = nullptr;
+  size_t size = 0;
+
+  const atUint8* begin() const { return data; }
+  const atUint8* end() const { return data + size; }
+  bool empty() const { return size == 0; }
+  atUint8 operator[](size_t idx) const { return data[idx]; }
+};
+
 /** @brief The IStreamReader class defines a basic API for reading from streams, Implementors are provided with one pure
  * virtual function that must be implemented in order to interact with the stream.
  *
  *  Most implementing classes will only need to implement IStreamReader::readUBytesToBuf(void*, atUint64) for basic
  * stream interaction
+ *
+ *  Implementors with their data already in memory may additionally expose it through the [m_cur, m_end) window,
+ * which the scalar and vector reads consume inline without a virtual call. IStreamReader::underflow(atUint64) is
+ * consulted when the window runs short, much like std::streambuf.
  */
 class IStreamReader : public IStream {
 public:
@@ -66,7 +84,7 @@ public:
    */
   atInt8 readByte() {
     atInt8 val = 0;
-    readUBytesToBuf(&val, 1);
+    readInline(&val, 1);
     return val;
   }
   template <class T>
@@ -106,7 +124,7 @@ public:
    */
   std::unique_ptr<atInt8[]> readBytes(atUint64 length) {
     auto buf = std::make_unique<atInt8[]>(length);
-    readUBytesToBuf(buf.get(), length);
+    readInline(buf.get(), length);
     return buf;
   }
 
@@ -116,16 +134,56 @@ public:
    */
   std::unique_ptr<atUint8[]> readUBytes(atUint64 length) {
     auto buf = std::make_unique<atUint8[]>(length);
-    readUBytesToBuf(buf.get(), length);
+    readInline(buf.get(), length);
     return buf;
   }
 
+  /** @brief Reads len bytes and advances the current position, without copying when possible.
+   *
+   *  If the stream holds the bytes in memory, the view points straight into its buffer.
+   *  Otherwise they are read into a scratch buffer owned by the stream. Either way the view
+   *  is only guaranteed to stay valid until the next read, seek or view on this stream.
+   *  @param len The number of bytes to read
+   *  @return The bytes read; shorter than len if the stream ended first
+   */
+  ByteView readView(atUint64 len) {
+    if ((m_cur && atUint64(m_end - m_cur) >= len) || underflow(len)) {
+      ByteView ret{m_cur, size_t(len)};
+      m_cur += len;
+      return ret;
+    }
+
+    m_viewScratch.resize(size_t(len));
+    return {m_viewScratch.data(), size_t(readUBytesToBuf(m_viewScratch.data(), len))};
+  }
+
+  /** @brief Returns the next len bytes without advancing the current position.
+   *
+   *  The same validity rules as readView apply.
+   *  @param len The number of bytes to peek at
+   *  @return The bytes available; shorter than len if the stream ends first, empty at the end.
+   *          Peeking past the end doesn't set the error state.
+   */
+  ByteView peekView(atUint64 len) {
+    if ((m_cur && atUint64(m_end - m_cur) >= len) || underflow(len))
+      return {m_cur, size_t(len)};
+
+    const atUint64 pos = position();
+    const atUint64 end = length();
+    if (pos >= end)
+      return {};
+    len = std::min(len, end - pos);
+    ByteView ret = readView(len);
+    seek(pos, SeekOrigin::Begin);
+    return ret;
+  }
+
   /** @brief Attempts to read a fixed length of data into a pre-allocated buffer.
    *  @param buf The buffer to read into
    *  @param len The length of the buffer
    *  @return How much data was actually read, useful for detecting read errors.
    */
-  atUint64 readBytesToBuf(void* buf, atUint64 len) { return readUBytesToBuf(buf, len); }
+  atUint64 readBytesToBuf(void* buf, atUint64 len) { return readInline(buf, len); }
 
   /** @brief Attempts to read a fixed length of data into a pre-allocated buffer, this function is client defined
    *  and must be implemented.
@@ -142,7 +200,7 @@ public:
    */
   atInt16 readInt16() {
     atInt16 val = 0;
-    readUBytesToBuf(&val, 2);
+    readInline(&val, 2);
     return m_endian == Endian::Big ? utility::BigInt16(val) : utility::LittleInt16(val);
   }
   template <class T>
@@ -157,7 +215,7 @@ public:
    */
   atInt16 readInt16Little() {
     atInt16 val = 0;
-    readUBytesToBuf(&val, 2);
+    readInline(&val, 2);
     return utility::LittleInt16(val);
   }
   template <class T>
@@ -172,7 +230,7 @@ public:
    */
   atInt16 readInt16Big() {
     atInt16 val = 0;
-    readUBytesToBuf(&val, 2);
+    readInline(&val, 2);
     return utility::BigInt16(val);
   }
   template <class T>
@@ -198,7 +256,7 @@ public:
    */
   atUint16 readUint16Little() {
     atUint16 val = 0;
-    readUBytesToBuf(&val, 2);
+    readInline(&val, 2);
     return utility::LittleUint16(val);
   }
   template <class T>
@@ -213,7 +271,7 @@ public:
    */
   atUint16 readUint16Big() {
     atUint16 val = 0;
-    readUBytesToBuf(&val, 2);
+    readInline(&val, 2);
     return utility::BigUint16(val);
   }
   template <class T>
@@ -228,7 +286,7 @@ public:
    */
   atInt32 readInt32() {
     atInt32 val = 0;
-    readUBytesToBuf(&val, 4);
+    readInline(&val, 4);
     return m_endian == Endian::Big ? utility::BigInt32(val) : utility::LittleInt32(val);
   }
   template <class T>
@@ -243,7 +301,7 @@ public:
    */
   atInt32 readInt32Little() {
     atInt32 val = 0;
-    readUBytesToBuf(&val, 4);
+    readInline(&val, 4);
     return utility::LittleInt32(val);
   }
   template <class T>
@@ -258,7 +316,7 @@ public:
    */
   atInt32 readInt32Big() {
     atInt32 val = 0;
-    readUBytesToBuf(&val, 4);
+    readInline(&val, 4);
     return utility::BigInt32(val);
   }
   template <class T>
@@ -284,7 +342,7 @@ public:
    */
   atUint32 readUint32Little() {
     atUint32 val = 0;
-    readUBytesToBuf(&val, 4);
+    readInline(&val, 4);
     return utility::LittleUint32(val);
   }
   template <class T>
@@ -299,7 +357,7 @@ public:
    */
   atUint32 readUint32Big() {
     atUint32 val = 0;
-    readUBytesToBuf(&val, 4);
+    readInline(&val, 4);
     return utility::BigUint32(val);
   }
   template <class T>
@@ -314,7 +372,7 @@ public:
    */
   atInt64 readInt64() {
     atInt64 val = 0;
-    readUBytesToBuf(&val, 8);
+    readInline(&val, 8);
     return m_endian == Endian::Big ? utility::BigInt64(val) : utility::LittleInt64(val);
   }
   template <class T>
@@ -329,7 +387,7 @@ public:
    */
   atInt64 readInt64Little() {
     atInt64 val = 0;
-    readUBytesToBuf(&val, 8);
+    readInline(&val, 8);
     return utility::LittleInt64(val);
   }
   template <class T>
@@ -344,7 +402,7 @@ public:
    */
   atInt64 readInt64Big() {
     atInt64 val = 0;
-    readUBytesToBuf(&val, 8);
+    readInline(&val, 8);
     return utility::BigInt64(val);
   }
   template <class T>
@@ -370,7 +428,7 @@ public:
    */
   atUint64 readUint64Little() {
     atUint64 val = 0;
-    readUBytesToBuf(&val, 8);
+    readInline(&val, 8);
     return utility::LittleUint64(val);
   }
   template <class T>
@@ -385,7 +443,7 @@ public:
    */
   atUint64 readUint64Big() {
     atUint64 val = 0;
-    readUBytesToBuf(&val, 8);
+    readInline(&val, 8);
     return utility::BigUint64(val);
   }
   template <class T>
@@ -400,7 +458,7 @@ public:
    */
   float readFloat() {
     float val = 0.f;
-    readUBytesToBuf(&val, 4);
+    readInline(&val, 4);
     return m_endian == Endian::Big ? utility::BigFloat(val) : utility::LittleFloat(val);
   }
   template <class T>
@@ -415,7 +473,7 @@ public:
    */
   float readFloatLittle() {
     float val = 0.f;
-    readUBytesToBuf(&val, 4);
+    readInline(&val, 4);
     return utility::LittleFloat(val);
   }
   template <class T>
@@ -430,7 +488,7 @@ public:
    */
   float readFloatBig() {
     float val = 0.f;
-    readUBytesToBuf(&val, 4);
+    readInline(&val, 4);
     return utility::BigFloat(val);
   }
   template <class T>
@@ -445,7 +503,7 @@ public:
    */
   double readDouble() {
     double val = 0.0;
-    readUBytesToBuf(&val, 8);
+    readInline(&val, 8);
     return m_endian == Endian::Big ? utility::BigDouble(val) : utility::LittleDouble(val);
   }
   template <class T>
@@ -460,7 +518,7 @@ public:
    */
   double readDoubleLittle() {
     double val = 0.0;
-    readUBytesToBuf(&val, 8);
+    readInline(&val, 8);
     return utility::LittleDouble(val);
   }
   template <class T>
@@ -475,7 +533,7 @@ public:
    */
   double readDoubleBig() {
     double val = 0.0;
-    readUBytesToBuf(&val, 8);
+    readInline(&val, 8);
     return utility::BigDouble(val);
   }
   template <class T>
@@ -489,7 +547,7 @@ public:
    */
   bool readBool() {
     atUint8 val = false;
-    readUBytesToBuf(&val, 1);
+    readInline(&val, 1);
     return val != 0;
   }
   template <class T>
@@ -512,7 +570,7 @@ public:
    */
   atVec2f readVec2f() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 8);
+    readInline(val.data(), 8);
     if (m_endian == Endian::Big) {
       val[0] = utility::BigFloat(val[0]);
       val[1] = utility::BigFloat(val[1]);
@@ -538,7 +596,7 @@ public:
    */
   atVec2f readVec2fLittle() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 8);
+    readInline(val.data(), 8);
     val[0] = utility::LittleFloat(val[0]);
     val[1] = utility::LittleFloat(val[1]);
     val[2] = 0.f;
@@ -559,7 +617,7 @@ public:
    */
   atVec2f readVec2fBig() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 8);
+    readInline(val.data(), 8);
     val[0] = utility::BigFloat(val[0]);
     val[1] = utility::BigFloat(val[1]);
     val[2] = 0.f;
@@ -580,7 +638,7 @@ public:
    */
   atVec3f readVec3f() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 12);
+    readInline(val.data(), 12);
     if (m_endian == Endian::Big) {
       val[0] = utility::BigFloat(val[0]);
       val[1] = utility::BigFloat(val[1]);
@@ -607,7 +665,7 @@ public:
    */
   atVec3f readVec3fLittle() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 12);
+    readInline(val.data(), 12);
     val[0] = utility::LittleFloat(val[0]);
     val[1] = utility::LittleFloat(val[1]);
     val[2] = utility::LittleFloat(val[2]);
@@ -628,7 +686,7 @@ public:
    */
   atVec3f readVec3fBig() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 12);
+    readInline(val.data(), 12);
     val[0] = utility::BigFloat(val[0]);
     val[1] = utility::BigFloat(val[1]);
     val[2] = utility::BigFloat(val[2]);
@@ -649,7 +707,7 @@ public:
    */
   atVec4f readVec4f() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 16);
+    readInline(val.data(), 16);
     if (m_endian == Endian::Big) {
       val[0] = utility::BigFloat(val[0]);
       val[1] = utility::BigFloat(val[1]);
@@ -677,7 +735,7 @@ public:
    */
   atVec4f readVec4fLittle() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 16);
+    readInline(val.data(), 16);
     val[0] = utility::LittleFloat(val[0]);
     val[1] = utility::LittleFloat(val[1]);
     val[2] = utility::LittleFloat(val[2]);
@@ -698,7 +756,7 @@ public:
    */
   atVec4f readVec4fBig() {
     simd_floats val = {};
-    readUBytesToBuf(val.data(), 16);
+    readInline(val.data(), 16);
     val[0] = utility::BigFloat(val[0]);
     val[1] = utility::BigFloat(val[1]);
     val[2] = utility::BigFloat(val[2]);
@@ -719,7 +777,7 @@ public:
    */
   atVec2d readVec2d() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 16);
+    readInline(val.data(), 16);
     if (m_endian == Endian::Big) {
       val[0] = utility::BigDouble(val[0]);
       val[1] = utility::BigDouble(val[1]);
@@ -745,7 +803,7 @@ public:
    */
   atVec2d readVec2dLittle() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 16);
+    readInline(val.data(), 16);
     val[0] = utility::LittleDouble(val[0]);
     val[1] = utility::LittleDouble(val[1]);
     val[2] = 0.0;
@@ -766,7 +824,7 @@ public:
    */
   atVec2d readVec2dBig() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 16);
+    readInline(val.data(), 16);
     val[0] = utility::BigDouble(val[0]);
     val[1] = utility::BigDouble(val[1]);
     val[2] = 0.0;
@@ -787,7 +845,7 @@ public:
    */
   atVec3d readVec3d() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 24);
+    readInline(val.data(), 24);
     if (m_endian == Endian::Big) {
       val[0] = utility::BigDouble(val[0]);
       val[1] = utility::BigDouble(val[1]);
@@ -814,7 +872,7 @@ public:
    */
   atVec3d readVec3dLittle() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 24);
+    readInline(val.data(), 24);
     val[0] = utility::LittleDouble(val[0]);
     val[1] = utility::LittleDouble(val[1]);
     val[2] = utility::LittleDouble(val[2]);
@@ -835,7 +893,7 @@ public:
    */
   atVec3d readVec3dBig() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 24);
+    readInline(val.data(), 24);
     val[0] = utility::BigDouble(val[0]);
     val[1] = utility::BigDouble(val[1]);
     val[2] = utility::BigDouble(val[2]);
@@ -856,7 +914,7 @@ public:
    */
   atVec4d readVec4d() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 32);
+    readInline(val.data(), 32);
     if (m_endian == Endian::Big) {
       val[0] = utility::BigDouble(val[0]);
       val[1] = utility::BigDouble(val[1]);
@@ -884,7 +942,7 @@ public:
    */
   atVec4d readVec4dLittle() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 32);
+    readInline(val.data(), 32);
     val[0] = utility::LittleDouble(val[0]);
     val[1] = utility::LittleDouble(val[1]);
     val[2] = utility::LittleDouble(val[2]);
@@ -905,7 +963,7 @@ public:
    */
   atVec4d readVec4dBig() {
     simd_doubles val = {};
-    readUBytesToBuf(val.data(), 32);
+    readInline(val.data(), 32);
     val[0] = utility::BigDouble(val[0]);
     val[1] = utility::BigDouble(val[1]);
     val[2] = utility::BigDouble(val[2]);
@@ -1213,6 +1271,95 @@ public:
       readf(*this, vector.back());
     }
   }
+
+  /** @brief Reads count values of type T with one bulk read, then byte swaps them as a batch
+   *
+   *  Supports all integer and floating point types as well as the atVec types.
+   *
+   *  @param dst The buffer to read count values into
+   *  @param count The number of values to read
+   *  @return The number of values actually read
+   */
+  template <class T, Endian E>
+  size_t readArray(T* dst, size_t count) {
+    static_assert((std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) || VecTraits<T>::IsVec,
+                  "readArray requires a numeric or vector type");
+    if (!count)
+      return 0;
+
+    if constexpr (std::is_arithmetic_v<T>) {
+      const size_t ret = size_t(readInline(dst, count * sizeof(T)) / sizeof(T));
+      if constexpr (sizeof(T) > 1)
+        if (E != utility::SystemEndian)
+          utility::swapArray<sizeof(T)>(dst, dst, ret);
+      return ret;
+    } else {
+      /* Vectors are padded in memory, so components are staged and swapped in chunks */
+      using CompT = typename VecTraits<T>::Type;
+      constexpr size_t Stride = sizeof(CompT) * VecTraits<T>::Count;
+      alignas(16) atUint8 chunk[4096];
+      size_t ret = 0;
+      while (ret < count) {
+        const size_t want = std::min(count - ret, sizeof(chunk) / Stride);
+        const size_t got = size_t(readInline(chunk, want * Stride) / Stride);
+        if (E != utility::SystemEndian)
+          utility::swapArray<sizeof(CompT)>(chunk, chunk, got * VecTraits<T>::Count);
+        for (size_t i = 0; i < got; ++i) {
+          simd_values<CompT> val = {};
+          memcpy(val.data(), chunk + i * Stride, Stride);
+          dst[ret + i].simd.copy_from(val);
+        }
+        ret += got;
+        if (got < want)
+          break;
+      }
+      return ret;
+    }
+  }
+
+  /** @brief Reads count values of type T with one bulk read, in the endianness specified by setEndian
+   *
+   *  @param dst The buffer to read count values into
+   *  @param count The number of values to read
+   *  @return The number of values actually read
+   */
+  template <class T>
+  size_t readArray(T* dst, size_t count) {
+    return m_endian == Endian::Big ? readArray<T, Endian::Big>(dst, count) : readArray<T, Endian::Little>(dst, count);
+  }
+
+protected:
+  /** @brief Refills the inline read window so that at least len bytes are available at m_cur.
+   *
+   *  Called when an inline read finds fewer than len bytes left in the window. Implementors that maintain a
+   *  window refill it here; returning false sends the read through readUBytesToBuf instead, which must then
+   *  account for any bytes left in the window. The default provides no window at all.
+   *  @param len The number of bytes the pending read needs
+   *  @return True if the window now holds at least len bytes
+   */
+  virtual bool underflow(atUint64 /*len*/) { return false; }
+
+  /** @brief Reads through the window when it holds enough bytes, otherwise through readUBytesToBuf
+   *  @param buf The buffer to read into
+   *  @param len The length of the buffer
+   *  @return How much data was actually read
+   */
+  atUint64 readInline(void* buf, atUint64 len) {
+    if ((m_cur && atUint64(m_end - m_cur) >= len) || underflow(len)) {
+      memcpy(buf, m_cur, len);
+      m_cur += len;
+      return len;
+    }
+    return readUBytesToBuf(buf, len);
+  }
+
+  /* Unread bytes at the current position, owned by the implementor */
+  const atUint8* m_cur = nullptr;
+  const atUint8* m_end = nullptr;
+
+private:
+  /* Backs views of streams that can't expose their own storage */
+  std::vector<atUint8> m_viewScratch;
 };
 template <typename T>
 IStreamReader& operator>>(IStreamReader& lhs, T& rhs) {
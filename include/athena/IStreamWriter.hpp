@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -994,6 +996,64 @@ public:
 
   void fill(atInt8 val, atUint64 length) { fill((atUint8)val, length); }
 
+  /** @brief Writes count values of type T, byte swapping them in batches through a staging buffer
+   *
+   *  Supports all integer and floating point types as well as the atVec types.
+   *  Each staged chunk is handed to writeUBytes in one call.
+   *
+   *  @param src The count values to write
+   *  @param count The number of values to write
+   */
+  template <class T, Endian E>
+  void writeArray(const T* src, size_t count) {
+    static_assert((std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) || VecTraits<T>::IsVec,
+                  "writeArray requires a numeric or vector type");
+    if (!count)
+      return;
+
+    alignas(16) atUint8 chunk[4096];
+    if constexpr (std::is_arithmetic_v<T> && sizeof(T) == 1) {
+      writeUBytes(reinterpret_cast<const atUint8*>(src), count);
+    } else if constexpr (std::is_arithmetic_v<T>) {
+      if (E == utility::SystemEndian) {
+        writeUBytes(reinterpret_cast<const atUint8*>(src), count * sizeof(T));
+        return;
+      }
+
+      constexpr size_t ChunkCount = sizeof(chunk) / sizeof(T);
+      for (size_t i = 0; i < count; i += ChunkCount) {
+        const size_t n = std::min(count - i, ChunkCount);
+        utility::swapArray<sizeof(T)>(chunk, src + i, n);
+        writeUBytes(chunk, n * sizeof(T));
+      }
+    } else {
+      /* Vectors are padded in memory, so only their components are staged */
+      using CompT = typename VecTraits<T>::Type;
+      constexpr size_t Stride = sizeof(CompT) * VecTraits<T>::Count;
+      constexpr size_t ChunkCount = sizeof(chunk) / Stride;
+      for (size_t i = 0; i < count; i += ChunkCount) {
+        const size_t n = std::min(count - i, ChunkCount);
+        for (size_t j = 0; j < n; ++j) {
+          simd_values<CompT> val(src[i + j].simd);
+          memcpy(chunk + j * Stride, val.data(), Stride);
+        }
+        if (E != utility::SystemEndian)
+          utility::swapArray<sizeof(CompT)>(chunk, chunk, n * VecTraits<T>::Count);
+        writeUBytes(chunk, n * Stride);
+      }
+    }
+  }
+
+  /** @brief Writes count values of type T in the endianness specified by setEndian
+   *
+   *  @param src The count values to write
+   *  @param count The number of values to write
+   */
+  template <class T>
+  void writeArray(const T* src, size_t count) {
+    m_endian == Endian::Big ? writeArray<T, Endian::Big>(src, count) : writeArray<T, Endian::Little>(src, count);
+  }
+
   /** @brief Performs automatic std::vector enumeration writes using numeric type T
    *  @param vector The std::vector read from when writing data
    *
@@ -1043,6 +1103,36 @@ public:
     for (const T& item : vector)
       item.write(*this);
   }
+
+protected:
+  /** @brief Seeks a writer that can only append by writing zeros up to the target
+   *
+   *  Seeking backwards is an error, nothing is written then.
+   *  @param position where in the stream to seek
+   *  @param origin The location to seek relative to
+   *  @param globalErr Whether or not global errors are enabled.
+   */
+  void seekForwardWithZeros(atInt64 position, SeekOrigin origin, bool globalErr) {
+    atInt64 delta = position;
+    if (origin == SeekOrigin::Begin)
+      delta = position - atInt64(this->position());
+    else if (origin == SeekOrigin::End)
+      delta = atInt64(length()) - position - atInt64(this->position());
+
+    if (delta < 0) {
+      if (globalErr)
+        atError(fmt("Unable to seek backwards in a stream that can only be appended to"));
+      setError();
+      return;
+    }
+
+    static constexpr atUint8 Zeros[256] = {};
+    while (delta > 0) {
+      const atUint64 len = std::min<atUint64>(atUint64(delta), sizeof(Zeros));
+      writeUBytes(Zeros, len);
+      delta -= atInt64(len);
+    }
+  }
 };
 
 template <typename T>
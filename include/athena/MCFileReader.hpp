@@ -29,8 +29,9 @@ public:
    *  \brief This constructor creates an instance from a file on disk.
    *
    *  \param filename The file to create the stream from
+   *  \param mapFile  Map the file instead of reading it into memory
    */
-  MCFileReader(const std::string&);
+  MCFileReader(const std::string&, bool mapFile = false);
 
   /*!
    *  \brief Reads the save data from the buffer
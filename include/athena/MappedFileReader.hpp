@@ -0,0 +1,75 @@
+#pragma once
+
+#if _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+#include <string>
+#include <string_view>
+
+#include "athena/MemoryReader.hpp"
+
+namespace athena::io {
+/*! \enum MapAdvice
+ *  \brief Access pattern hint forwarded to the OS (madvise) for a mapped range
+ */
+enum class MapAdvice { Normal, Sequential, Random, WillNeed };
+
+/*! \class MappedFileReader
+ *  \brief A MemoryReader backed by a memory-mapped file
+ *
+ *  The file is mapped into the address space instead of being read into a heap copy,
+ *  so opening a file costs neither a copy nor an up-front read; pages are faulted in
+ *  as the stream touches them.
+ *  \sa MemoryReader
+ */
+class MappedFileReader : public MemoryReader {
+public:
+  /*! \brief Maps a file on disk for reading.
+   *
+   *   \param filename    The file to map
+   *   \param copyOnWrite Map the file privately and writable so the buffer may be edited
+   *                      in-place without the changes reaching the file on disk
+   *   \param advice      Initial access pattern hint for the whole mapping
+   *   \param globalErr   Whether or not global errors are enabled.
+   */
+  explicit MappedFileReader(std::string_view filename, bool copyOnWrite = false,
+                            MapAdvice advice = MapAdvice::Normal, bool globalErr = true);
+  ~MappedFileReader() override;
+
+  std::string filename() const { return m_filename; }
+
+  void close();
+  bool isOpen() const { return m_mapping != nullptr; }
+  bool isCopyOnWrite() const { return m_copyOnWrite; }
+
+  /*! \brief Gives the OS an access pattern hint for part of the mapping.
+   *
+   *   \param advice The hint to apply
+   *   \param offset Start of the range within the file
+   *   \param length Length of the range; 0 applies to the rest of the file
+   */
+  void advise(MapAdvice advice, atUint64 offset = 0, atUint64 length = 0);
+
+  /*! \brief Returns the mapped buffer for in-place editing.
+   *
+   *  \return The mapping if opened copy-on-write; nullptr otherwise.
+   */
+  atUint8* mutableData() const { return m_copyOnWrite ? static_cast<atUint8*>(m_mapping) : nullptr; }
+
+protected:
+  void open();
+
+  std::string m_filename;
+  void* m_mapping = nullptr;
+#if _WIN32
+  HANDLE m_fileHandle = INVALID_HANDLE_VALUE;
+  HANDLE m_mapHandle = nullptr;
+#endif
+  bool m_copyOnWrite;
+  MapAdvice m_advice;
+};
+} // namespace athena::io
@@ -6,6 +6,8 @@
 #include "athena/IStreamReader.hpp"
 
 namespace athena::io {
+class MappedFileReader;
+
 /*! \class MemoryReader
  *  \brief A Stream class for reading data from a memory position
  *
@@ -41,7 +43,7 @@ public:
    *
    *  \return Int64 The current position in the stream.
    */
-  atUint64 position() const override { return m_position; }
+  atUint64 position() const override { return m_cur ? atUint64(m_cur - static_cast<const atUint8*>(m_data)) : 0; }
 
   /*! \brief Returns whether or not the stream is at the end.
    *
@@ -78,15 +80,29 @@ public:
   atUint64 readUBytesToBuf(void* buf, atUint64 len) override;
 
 protected:
+  /*! \brief Points the inline read window at the whole buffer and rewinds to its start.
+   *         Must be called whenever m_data or m_length change.
+   */
+  void resetWindow() {
+    m_cur = static_cast<const atUint8*>(m_data);
+    m_end = m_cur + m_length;
+  }
+
+  /* The read position lives in m_cur; the window always spans the whole buffer */
   const void* m_data = nullptr;
   atUint64 m_length = 0;
-  atUint64 m_position = 0;
   bool m_owns = false;
   bool m_globalErr = true;
 };
 
 class MemoryCopyReader : public MemoryReader {
 public:
+  /*! \brief How a file on disk is brought into memory */
+  enum class Load {
+    Copy, //!< Read the whole file into a heap buffer
+    Map   //!< Map the file copy-on-write; pages are read on first access
+  };
+
   /*! \brief This constructor copies an existing buffer to read from.
    *
    *   \param data The existing buffer
@@ -97,14 +113,21 @@ public:
   /*! \brief This constructor creates an instance from a file on disk.
    *
    * \param filename The file to create the stream from
+   * \param load     Whether to copy or map the file
    */
-  explicit MemoryCopyReader(const std::string& filename) : m_filepath(filename) { loadData(); }
+  explicit MemoryCopyReader(const std::string& filename, Load load = Load::Copy);
+
+  ~MemoryCopyReader() override;
 
   void setData(const atUint8* data, atUint64 length);
 
 protected:
   void loadData();
+  void mapData();
+  /*! \brief The buffer being read from as writable, either the heap copy or the private mapping */
+  atUint8* mutableData() const;
   std::unique_ptr<atUint8[]> m_dataCopy;
+  std::unique_ptr<MappedFileReader> m_mappedFile;
   std::string m_filepath; //!< Path to the target file
 };
 
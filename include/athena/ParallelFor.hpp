@@ -0,0 +1,20 @@
+#pragma once
+
+#include <functional>
+
+#include "athena/Types.hpp"
+
+namespace athena {
+/*! \brief How many threads parallelFor runs count items on
+ *
+ *  threads of 0 means one per hardware thread. Never more than count, and at least 1.
+ */
+atUint32 parallelThreads(size_t count, atUint32 threads);
+
+/*! \brief Calls fn(worker, index) once for every index below count, spread over parallelThreads(count, threads)
+ *
+ *  Indices are handed out in order to whichever thread is free next. The calling thread is worker 0 and works
+ *  alongside the others, so a single thread runs everything in place. Returns once all indices are done.
+ */
+void parallelFor(size_t count, atUint32 threads, const std::function<void(atUint32 worker, size_t index)>& fn);
+} // namespace athena
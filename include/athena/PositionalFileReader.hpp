@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "athena/IStreamReader.hpp"
+#include "athena/Types.hpp"
+
+namespace athena::io {
+/*! \class PositionalFileReader
+ *  \brief A file reader using positional reads (pread) on a shared descriptor
+ *
+ *  Unlike FileReader, no read moves a file-wide cursor, so any number of readers may
+ *  share one open descriptor. Copying a PositionalFileReader (or calling cursor()) is cheap
+ *  and yields an independent cursor over the same file and block cache; give each thread
+ *  its own cursor and they may all read concurrently.
+ *
+ *  Each cursor keeps the block it last read from. If a shared cache is requested, blocks
+ *  are additionally kept in an LRU cache shared by all cursors of the file.
+ *  \sa FileReader
+ */
+class PositionalFileReader : public IStreamReader {
+public:
+  /*! \brief Opens a file for positional reading.
+   *
+   *   \param filename    The file to open
+   *   \param blockSize   Size of each cached block
+   *   \param cacheBlocks Number of blocks in the shared cache; 0 disables sharing
+   *   \param globalErr   Whether or not global errors are enabled.
+   */
+  explicit PositionalFileReader(std::string_view filename, atInt32 blockSize = (32 * 1024), atInt32 cacheBlocks = 0,
+                                bool globalErr = true);
+
+  PositionalFileReader(const PositionalFileReader& other);
+  PositionalFileReader& operator=(const PositionalFileReader& other);
+  PositionalFileReader(PositionalFileReader&& other) = default;
+  PositionalFileReader& operator=(PositionalFileReader&& other) = default;
+  ~PositionalFileReader() override = default;
+
+  /*! \brief Creates a new cursor over the same file and cache.
+   *
+   *   \param offset Initial position of the new cursor
+   */
+  PositionalFileReader cursor(atUint64 offset = 0) const;
+
+  std::string filename() const;
+  bool isOpen() const;
+
+  void seek(atInt64 pos, SeekOrigin origin = SeekOrigin::Current) override;
+  atUint64 position() const override { return m_offset; }
+  atUint64 length() const override;
+  atUint64 readUBytesToBuf(void* buf, atUint64 len) override;
+
+  /*! \brief Reads at an absolute offset without moving this cursor; safe from any thread */
+  atUint64 readAt(atUint64 offset, void* buf, atUint64 len) const;
+
+  atUint64 cacheHits() const;
+  atUint64 cacheMisses() const;
+
+private:
+  struct Block {
+    atUint64 index;
+    atUint64 size;
+    std::unique_ptr<atUint8[]> data;
+  };
+  using BlockPtr = std::shared_ptr<const Block>;
+
+  /* State shared by every cursor of one file */
+  struct Shared {
+    ~Shared();
+    atUint64 pread(atUint64 offset, void* buf, atUint64 len) const;
+    BlockPtr loadBlock(atUint64 index);
+
+    std::string filename;
+#if _WIN32
+    void* handle = nullptr;
+#else
+    int fd = -1;
+#endif
+    atUint64 length = 0;
+    atInt32 blockSize;
+    atInt32 cacheBlocks;
+
+    std::mutex cacheLock;
+    std::list<BlockPtr> lru; /* front is most recently used */
+    std::unordered_map<atUint64, std::list<BlockPtr>::iterator> lookup;
+    std::atomic<atUint64> hits{0};
+    std::atomic<atUint64> misses{0};
+  };
+
+  PositionalFileReader(std::shared_ptr<Shared> shared, atUint64 offset, bool globalErr);
+  const Block* block(atUint64 index);
+
+  std::shared_ptr<Shared> m_shared;
+  BlockPtr m_block;
+  atUint64 m_offset = 0;
+  bool m_globalErr;
+};
+} // namespace athena::io
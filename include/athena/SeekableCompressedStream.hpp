@@ -0,0 +1,162 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "athena/Compression.hpp"
+#include "athena/IStreamReader.hpp"
+#include "athena/IStreamWriter.hpp"
+#include "athena/Types.hpp"
+
+namespace athena::io {
+/*! \brief Codec used for every block of a seekable compressed stream */
+enum class ChunkCodec : atUint8 { Zlib, Yaz0, LZ10, LZ11 };
+
+/*! \class SeekableCompressedWriter
+ *  \brief A Stream class that writes data as independently compressed blocks for random access
+ *
+ *  The layout, all little endian:
+ *   - A 0x10 byte header: magic 'ACHK', version, codec and block size.
+ *   - The compressed blocks back to back. A block that does not shrink is stored as is.
+ *   - An index with each block's offset, compressed size and the CRC32 of its decompressed data.
+ *   - A 0x18 byte footer: index offset, decompressed length, block count and the magic again.
+ *
+ *  Offsets are relative to the header. Seeking can only move forward, filling the gap with zeros.
+ *  The stream is completed by finish(), or on destruction.
+ *  \sa SeekableCompressedReader
+ */
+class SeekableCompressedWriter : public IStreamWriter {
+public:
+  /*! \brief Wraps an existing destination stream.
+   *
+   *   \param destination The stream receiving the container
+   *   \param codec       How the blocks are compressed
+   *   \param blockSize   Decompressed size of every block but the last
+   *   \param globalErr   Whether or not global errors are enabled.
+   */
+  explicit SeekableCompressedWriter(std::unique_ptr<IStreamWriter>&& destination, ChunkCodec codec = ChunkCodec::Zlib,
+                                    atUint32 blockSize = 0x10000, bool globalErr = true);
+  ~SeekableCompressedWriter() override;
+
+  /*! \brief Compresses the last block and writes the index, further writes fail */
+  void finish();
+
+  /*! \brief Returns the destination stream */
+  IStreamWriter& destination() const { return *m_destination; }
+
+  void seek(atInt64 pos, SeekOrigin origin = SeekOrigin::Current) override;
+  atUint64 position() const override { return m_position; }
+  atUint64 length() const override { return m_position; }
+  void writeUBytes(const atUint8* data, atUint64 len) override;
+
+private:
+  struct IndexEntry {
+    atUint64 offset;
+    atUint32 compressedSize;
+    atUint32 crc;
+  };
+
+  bool flushBlock();
+
+  std::unique_ptr<IStreamWriter> m_destination;
+  ChunkCodec m_codec;
+  atUint32 m_blockSize;
+  std::vector<atUint8> m_block;
+  std::vector<atUint8> m_compressed;
+  size_t m_blockUsed = 0;
+  std::vector<IndexEntry> m_index;
+  atUint64 m_start = 0;
+  atUint64 m_position = 0;
+  std::unique_ptr<Compression::ZlibCompressor> m_zlib;
+  std::unique_ptr<Compression::Yaz0Encoder> m_yaz0;
+  std::unique_ptr<Compression::LZ77Codec> m_lz;
+  bool m_finished = false;
+  bool m_globalErr;
+};
+
+/*! \class SeekableCompressedReader
+ *  \brief A Stream class that reads a SeekableCompressedWriter container with random access
+ *
+ *  Only the blocks a read touches are decompressed. Blocks read in part are kept in a small
+ *  cache of recently used blocks, blocks a read covers entirely are decompressed straight into
+ *  the caller's buffer, several at a time when more than one thread is allowed.
+ *  Every block is checked against its CRC32.
+ *
+ *  The source is owned by the reader and must not be used directly while wrapped.
+ *  \sa SeekableCompressedWriter
+ */
+class SeekableCompressedReader : public IStreamReader {
+public:
+  /*! \brief Wraps an existing source stream positioned at a container's header.
+   *
+   *   \param source      The stream holding the container
+   *   \param cacheBlocks How many decompressed blocks to keep, at least 2
+   *   \param threads     How many threads may decompress blocks at once
+   *   \param globalErr   Whether or not global errors are enabled.
+   */
+  explicit SeekableCompressedReader(std::unique_ptr<IStreamReader>&& source, atUint32 cacheBlocks = 4,
+                                    atUint32 threads = 1, bool globalErr = true);
+  ~SeekableCompressedReader() override;
+
+  ChunkCodec codec() const { return m_codec; }
+  atUint32 blockSize() const { return m_blockSize; }
+  atUint64 blockCount() const { return m_index.size(); }
+
+  void seek(atInt64 pos, SeekOrigin origin = SeekOrigin::Current) override;
+  atUint64 position() const override { return m_windowOffset + atUint64(m_cur - m_windowBegin); }
+  atUint64 length() const override { return m_length; }
+  atUint64 readUBytesToBuf(void* buf, atUint64 len) override;
+
+protected:
+  bool underflow(atUint64 len) override;
+
+private:
+  struct IndexEntry {
+    atUint64 offset;
+    atUint32 compressedSize;
+    atUint32 crc;
+  };
+
+  struct CacheEntry {
+    atUint64 block = ~atUint64(0);
+    atUint64 lastUse = 0;
+    std::vector<atUint8> data;
+  };
+
+  /* One per thread, the codecs that need state */
+  struct Decoder {
+    std::unique_ptr<Compression::ZlibDecompressor> zlib;
+    std::unique_ptr<Compression::LZ77Codec> lz;
+  };
+
+  /* A block to decompress, into a cache entry or straight into the caller's buffer */
+  struct Job {
+    atUint64 block;
+    atUint8* dst;
+    std::vector<atUint8> compressed;
+    bool ok;
+  };
+
+  bool readIndex();
+  atUint32 blockLength(atUint64 block) const;
+  CacheEntry* findCached(atUint64 block);
+  CacheEntry& allocateCached(atUint64 block);
+  bool runJobs(std::vector<Job>& jobs);
+  bool decodeJob(Decoder& decoder, Job& job) const;
+  const CacheEntry* loadBlock(atUint64 block);
+  void resetWindow(atUint64 offset);
+
+  std::unique_ptr<IStreamReader> m_source;
+  atUint64 m_sourceStart = 0;
+  ChunkCodec m_codec = ChunkCodec::Zlib;
+  atUint32 m_blockSize = 0;
+  atUint64 m_length = 0;
+  std::vector<IndexEntry> m_index;
+  std::vector<CacheEntry> m_cache;
+  atUint64 m_useCounter = 0;
+  std::vector<Decoder> m_decoders;
+  const atUint8* m_windowBegin = nullptr;
+  atUint64 m_windowOffset = 0; /* decompressed offset of m_windowBegin */
+  bool m_globalErr;
+};
+} // namespace athena::io
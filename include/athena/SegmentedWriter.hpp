@@ -0,0 +1,102 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "athena/IStreamWriter.hpp"
+#include "athena/Types.hpp"
+
+namespace athena::io {
+
+/*! @class SegmentedWriter
+ *  @brief A Stream class for writing data to a list of fixed size memory segments
+ *
+ *  Growing the stream only ever appends a new segment, so data already written is never
+ *  reallocated or copied no matter how large the output gets. Seeking back and patching
+ *  earlier data works across segment boundaries. The result can be written out with a
+ *  single gathered write or flattened into one contiguous buffer once at the end.
+ *  @sa MemoryCopyWriter
+ */
+class SegmentedWriter : public IStreamWriter {
+public:
+  /*! @brief Creates an empty stream.
+   *
+   *   @param segmentSize Size of each segment, rounded up to a power of two.
+   */
+  explicit SegmentedWriter(atUint32 segmentSize = 0x10000);
+
+  /*! @brief Sets the buffers position relative to the specified position.<br />
+   *         It seeks relative to the current position by default.
+   *         Seeking past the end zero fills the stream up to the new position.
+   *  @param position where in the buffer to seek
+   *  @param origin The Origin to seek @sa SeekOrigin
+   */
+  void seek(atInt64 position, SeekOrigin origin = SeekOrigin::Current) override;
+
+  /*! @brief Returns the current position in the stream.
+   *
+   *  @return Int64 The current position in the stream.
+   */
+  atUint64 position() const override { return m_position; }
+
+  /*! @brief Returns the length of the stream.
+   *
+   *  @return Int64 The length of the stream.
+   */
+  atUint64 length() const override { return m_length; }
+
+  bool isOpen() const { return true; }
+
+  /*! @brief Returns the size of each segment */
+  atUint32 segmentSize() const { return atUint32(1) << m_segmentShift; }
+
+  /*! @brief Returns the number of segments holding the stream's data */
+  size_t segmentCount() const { return size_t((m_length + segmentSize() - 1) >> m_segmentShift); }
+
+  /*! @brief Returns the data of the given segment */
+  const atUint8* segment(size_t idx) const { return m_segments[idx].get(); }
+
+  /*! @brief Returns how many bytes of the given segment are in use, only the last one may be partial */
+  atUint64 segmentLength(size_t idx) const;
+
+  /*! @brief Copies the whole stream into dst, which must hold at least length() bytes */
+  void flattenTo(atUint8* dst) const;
+
+  /*! @brief Returns a contiguous copy of the stream.<br />
+   *         The caller owns the returned buffer and must delete[] it.
+   *  @return Uint8* The copy of the buffer.
+   */
+  atUint8* data() const;
+
+  /*! @brief Writes the whole stream to another writer one segment at a time */
+  void writeTo(IStreamWriter& writer) const;
+
+  /*! @brief Saves the stream to the specified file, gathering every segment into as few writes as possible.
+   *
+   *   @param filename The file to save to
+   */
+  void save(std::string_view filename);
+
+  /*! @brief Empties the stream, keeping the segments already allocated for reuse */
+  void clear();
+
+  /*! @brief Writes the given buffer with the specified length, buffers can be bigger than the length
+   *  however it's undefined behavior to try and write a buffer which is smaller than the given length.
+   *
+   * @param data The buffer to write
+   * @param length The amount to write
+   */
+  void writeUBytes(const atUint8* data, atUint64 length) override;
+
+private:
+  void reserve(atUint64 size);
+  void zeroFill(atUint64 begin, atUint64 end);
+
+  std::vector<std::unique_ptr<atUint8[]>> m_segments;
+  atUint32 m_segmentShift;
+  atUint64 m_position = 0;
+  atUint64 m_length = 0;
+};
+
+} // namespace athena::io
@@ -8,7 +8,7 @@ namespace io {
 class SkywardSwordFileReader : public MemoryCopyReader {
 public:
   SkywardSwordFileReader(atUint8* data, atUint64 length);
-  SkywardSwordFileReader(const std::string& filename);
+  SkywardSwordFileReader(const std::string& filename, bool mapFile = false);
 
   SkywardSwordFile* read();
 };
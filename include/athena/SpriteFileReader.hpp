@@ -12,7 +12,7 @@ namespace io {
 class SpriteFileReader : public MemoryCopyReader {
 public:
   SpriteFileReader(atUint8* data, atUint64 length);
-  SpriteFileReader(const std::string& filepath);
+  SpriteFileReader(const std::string& filepath, bool mapFile = false);
 
   Sakura::SpriteFile* readFile();
 };
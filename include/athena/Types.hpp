@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cinttypes>
+#include <cstddef>
 #include <cstdint>
 
 using atInt8 = std::int8_t;
@@ -32,3 +33,25 @@ struct atVec3d {
 struct atVec4d {
   athena::simd<double> simd;
 };
+
+namespace athena {
+/* Component type and count of each vector type as laid out in a stream */
+template <typename T>
+struct VecTraits {
+  static constexpr bool IsVec = false;
+};
+#define ATHENA_VEC_TRAITS(vec, type, count)                                                                            \
+  template <>                                                                                                          \
+  struct VecTraits<vec> {                                                                                              \
+    static constexpr bool IsVec = true;                                                                                \
+    using Type = type;                                                                                                 \
+    static constexpr std::size_t Count = count;                                                                        \
+  };
+ATHENA_VEC_TRAITS(atVec2f, float, 2)
+ATHENA_VEC_TRAITS(atVec3f, float, 3)
+ATHENA_VEC_TRAITS(atVec4f, float, 4)
+ATHENA_VEC_TRAITS(atVec2d, double, 2)
+ATHENA_VEC_TRAITS(atVec3d, double, 3)
+ATHENA_VEC_TRAITS(atVec4d, double, 4)
+#undef ATHENA_VEC_TRAITS
+} // namespace athena
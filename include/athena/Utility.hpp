@@ -175,6 +175,23 @@ BSWAP_CONSTEXPR double BigDouble(double val) {
   return val;
 }
 
+/* Byte swaps count 2, 4 or 8-byte values from src into dst, which may be the same buffer.
+ * Uses SSSE3 or AVX2 shuffles when the running CPU supports them. */
+void swapArray16(void* dst, const void* src, size_t count);
+void swapArray32(void* dst, const void* src, size_t count);
+void swapArray64(void* dst, const void* src, size_t count);
+
+template <size_t Size>
+void swapArray(void* dst, const void* src, size_t count) {
+  static_assert(Size == 2 || Size == 4 || Size == 8, "unsupported value size");
+  if constexpr (Size == 2)
+    swapArray16(dst, src, count);
+  else if constexpr (Size == 4)
+    swapArray32(dst, src, count);
+  else
+    swapArray64(dst, src, count);
+}
+
 void fillRandom(atUint8* rndArea, atUint64 count);
 std::vector<std::string> split(std::string_view s, char delim);
 atUint64 rand64();
@@ -30,8 +30,9 @@ public:
   /*! \brief This constructor creates an instance from a file on disk.
    *
    * \param filename The file to create the stream from
+   * \param mapFile  Map the file instead of reading it into memory
    */
-  WiiSaveReader(const std::string&);
+  WiiSaveReader(const std::string&, bool mapFile = false);
 
   /*!
    * \brief readSave
@@ -25,8 +25,9 @@ public:
   /*!
    * \brief ZQuestFileReader
    * \param filename
+   * \param mapFile
    */
-  ZQuestFileReader(const std::string& filename);
+  ZQuestFileReader(const std::string& filename, bool mapFile = false);
 
   /*!
    * \brief read
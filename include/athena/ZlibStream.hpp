@@ -0,0 +1,96 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "athena/DecompressReader.hpp"
+#include "athena/IStreamWriter.hpp"
+#include "athena/Types.hpp"
+
+struct z_stream_s;
+
+namespace athena::io {
+/*! \class ZlibReader
+ *  \brief A Stream class that inflates a deflate stream as it is read
+ *
+ *  windowBits follows zlib's convention: 8 to 15 for zlib data, negated for raw
+ *  deflate data, plus 16 for gzip data or plus 32 to detect zlib or gzip from the header.
+ *  Deflate data does not record its decompressed length; unless it is given, length()
+ *  reports UnknownLength until the end of the data has been reached.
+ *  \sa DecompressReader
+ *  \sa ZlibWriter
+ */
+class ZlibReader : public DecompressReader {
+public:
+  /*! \brief Wraps an existing source stream positioned at the compressed data.
+   *
+   *   \param source     The stream holding the compressed data
+   *   \param windowBits Window size and format of the data
+   *   \param length     The decompressed length, if known
+   *   \param globalErr  Whether or not global errors are enabled.
+   */
+  explicit ZlibReader(std::unique_ptr<IStreamReader>&& source, atInt32 windowBits = 15 + 32,
+                      atUint64 length = UnknownLength, bool globalErr = true);
+  ~ZlibReader() override;
+
+protected:
+  bool readHeader(atUint64& length) override;
+  atUint8* decode(atUint8* out, atUint8* limit, atUint8* end) override;
+
+private:
+  std::unique_ptr<z_stream_s> m_stream;
+  atUint64 m_knownLength;
+  bool m_streamEnd = false;
+};
+
+/*! \class ZlibWriter
+ *  \brief A Stream class that deflates everything written to it into another stream
+ *
+ *  Writes are gathered into an input buffer and deflated a buffer at a time, compressed
+ *  output goes to the destination whenever the output buffer fills. Nothing is written
+ *  back, seeking can only move forward, filling the gap with zeros.
+ *
+ *  The stream is completed by finish(), or on destruction.
+ *  \sa ZlibReader
+ */
+class ZlibWriter : public IStreamWriter {
+public:
+  /*! \brief Wraps an existing destination stream.
+   *
+   *   \param destination The stream receiving the compressed data
+   *   \param level       Compression level from 0 to 9, or -1 for zlib's default
+   *   \param windowBits  Window size and format of the data, as for ZlibReader but without detection
+   *   \param bufferSize  Size of the input and output buffers
+   *   \param globalErr   Whether or not global errors are enabled.
+   */
+  explicit ZlibWriter(std::unique_ptr<IStreamWriter>&& destination, atInt32 level = -1, atInt32 windowBits = 15,
+                      atUint32 bufferSize = 0x10000, bool globalErr = true);
+  ~ZlibWriter() override;
+
+  /*! \brief Compresses everything written so far and ends the stream, further writes fail */
+  void finish();
+
+  /*! \brief Returns the destination stream */
+  IStreamWriter& destination() const { return *m_destination; }
+
+  /*! \brief Returns how many compressed bytes have been produced */
+  atUint64 compressedLength() const;
+
+  void seek(atInt64 pos, SeekOrigin origin = SeekOrigin::Current) override;
+  atUint64 position() const override { return m_position; }
+  atUint64 length() const override { return m_position; }
+  void writeUBytes(const atUint8* data, atUint64 len) override;
+
+private:
+  bool deflateInput(atInt32 flush);
+
+  std::unique_ptr<IStreamWriter> m_destination;
+  std::unique_ptr<z_stream_s> m_stream;
+  std::vector<atUint8> m_input;
+  std::vector<atUint8> m_output;
+  size_t m_inputUsed = 0;
+  atUint64 m_position = 0;
+  bool m_finished = false;
+  bool m_globalErr;
+};
+} // namespace athena::io
@@ -1,16 +1,20 @@
 #include "LZ77/LZLookupTable.hpp"
 #include "LZ77/LZBase.hpp"
+#include "LZ77/LZMatch.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include <athena/Compression.hpp>
 
 namespace {
+// A literal is a flag bit and the byte itself
+constexpr atUint32 LiteralCost = 9;
+
 // Returns the full length of string2 if they are equal else
 // Return the number of characters that were equal before they weren't equal
-int subMatch(const uint8_t* str1, const uint8_t* str2, const int len) {
-  for (int i = 0; i < len; ++i)
-    if (str1[i] != str2[i])
-      return i;
-
-  return len;
-}
+int subMatch(const uint8_t* str1, const uint8_t* str2, const int len) { return lzMatchLength(str1, str2, len); }
 
 // Normally a search for one byte is matched, then two, then three, all the way up
 // to the size of the LookAheadBuffer. So I decided to skip the incremental search
@@ -89,6 +93,83 @@ void LZBase::setMinimumOffset(atUint32 minimumOffset) { m_minOffset = minimumOff
 
 atUint32 LZBase::minimumOffset() const { return m_minOffset; }
 
+void LZBase::setMaxChainDepth(atInt32 maxChainDepth) { m_lookupTable.setMaxChainDepth(maxChainDepth); }
+
+atInt32 LZBase::maxChainDepth() const { return m_lookupTable.maxChainDepth(); }
+
+void LZBase::setParseEffort(atInt32 parseEffort) { m_parseEffort = std::clamp(parseEffort, 0, MaxParseEffort); }
+
+atInt32 LZBase::parseEffort() const { return m_parseEffort; }
+
+void LZBase::parseOptimal(const atUint8* src, atUint32 srcLength) {
+  const atUint8* srcEnd = src + srcLength;
+  m_parseLength.resize(srcLength);
+  m_parseOffset.resize(srcLength);
+  m_parseCost.resize(size_t(srcLength) + 1);
+
+  // Inside a long match the same offset is assumed to stay best, long runs would be searched over and over otherwise
+  const atUint32 longMatch = 0x20u << m_parseEffort;
+  for (atUint32 pos = 0; pos < srcLength;) {
+    const LZLengthOffset found = m_lookupTable.search(src + pos, src, srcEnd);
+    m_parseLength[pos] = found.length >= atUint32(m_minMatch) ? found.length : 0;
+    m_parseOffset[pos++] = found.offset;
+
+    if (found.length >= longMatch) {
+      for (atUint32 remaining = found.length - 1; remaining >= longMatch; --remaining) {
+        m_parseLength[pos] = remaining;
+        m_parseOffset[pos++] = found.offset;
+      }
+    }
+  }
+
+  // Past the first few lengths only the longest of each encoded size is tried,
+  // since a shorter one of the same size rarely leaves a cheaper remainder
+  const atUint32 minMatch = atUint32(m_minMatch);
+  const atUint32 pricedEnd = minMatch + (2u << m_parseEffort);
+  std::vector<atUint32> sizeEnds;
+  for (atUint32 len = pricedEnd; len < atUint32(m_readAheadBuffer); ++len)
+    if (matchCost(len + 1) != matchCost(len))
+      sizeEnds.push_back(len);
+
+  // Walk backwards keeping the cheapest way to encode each suffix
+  m_parseCost[srcLength] = 0;
+  for (atUint32 pos = srcLength; pos-- > 0;) {
+    const atUint32 longest = m_parseLength[pos];
+    atUint64 bestCost = LiteralCost + m_parseCost[pos + 1];
+    atUint32 bestLength = 1;
+    const auto tryLength = [&](atUint32 len) {
+      const atUint64 cost = matchCost(len) + m_parseCost[pos + len];
+      if (cost < bestCost) {
+        bestCost = cost;
+        bestLength = len;
+      }
+    };
+
+    for (atUint32 len = minMatch; len <= std::min(longest, pricedEnd - 1); ++len)
+      tryLength(len);
+    for (atUint32 len : sizeEnds) {
+      if (len >= longest)
+        break;
+      tryLength(len);
+    }
+    if (longest >= pricedEnd)
+      tryLength(longest);
+
+    m_parseCost[pos] = bestCost;
+    m_parseLength[pos] = bestLength;
+  }
+}
+
+LZLengthOffset LZBase::nextMatch(const atUint8* posPtr, const atUint8* dataBegin, const atUint8* dataEnd) {
+  if (!m_parseEffort)
+    return m_lookupTable.search(posPtr, dataBegin, dataEnd);
+
+  const atUint32 pos = atUint32(posPtr - dataBegin);
+  if (m_parseLength[pos] < atUint32(m_minMatch))
+    return {0, 0};
+  return {m_parseLength[pos], m_parseOffset[pos]};
+}
+
 /*
   DerricMc:
   This search function is my own work and is no way affiliated with any one else
@@ -129,3 +210,38 @@ LZLengthOffset LZBase::search(const atUint8* posPtr, const atUint8* dataBegin, c
   return results;
 }
 
+athena::io::Compression::Status LZBase::readHeader(const atUint8* src, size_t srcLen, size_t& size,
+                                                   size_t& headerSize) {
+  using athena::io::Compression::Status;
+  if (srcLen < 4)
+    return Status::TruncatedInput;
+  if (src[0] != 0x10 && src[0] != 0x11)
+    return Status::InvalidData;
+
+  // The size is little endian, type 0x11 stores sizes past 24 bits in the following word.
+  // An empty stream has no such word.
+  size = src[1] | (src[2] << 8) | (src[3] << 16);
+  headerSize = 4;
+  if (src[0] == 0x11 && size == 0 && srcLen >= 8) {
+    size = src[4] | (src[5] << 8) | (src[6] << 16) | (atUint32(src[7]) << 24);
+    headerSize = 8;
+  }
+  return Status::Ok;
+}
+
+atUint32 LZBase::decompressAllocated(const atUint8* src, atUint8** dst, atUint32 srcLength) const {
+  using athena::io::Compression::Status;
+  size_t size, headerSize;
+  if (readHeader(src, srcLength, size, headerSize) != Status::Ok)
+    return 0;
+
+  auto uncompressedData = std::unique_ptr<atUint8[]>(new atUint8[size]);
+  size_t decompressedLen;
+  if (decompressInto(src, srcLength, uncompressedData.get(), size, decompressedLen) != Status::Ok) {
+    *dst = nullptr;
+    return 0;
+  }
+
+  *dst = uncompressedData.release();
+  return atUint32(decompressedLen);
+}
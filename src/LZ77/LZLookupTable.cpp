@@ -1,7 +1,9 @@
 #include "LZ77/LZLookupTable.hpp"
+#include "LZ77/LZMatch.hpp"
 #include <algorithm>
+#include <cstring>
 
-LZLookupTable::LZLookupTable() : m_buffer(m_minimumMatch) {}
+LZLookupTable::LZLookupTable() : LZLookupTable(3) {}
 
 LZLookupTable::LZLookupTable(atInt32 minimumMatch, atInt32 slidingWindow, atInt32 lookAheadWindow) {
   if (minimumMatch > 0)
@@ -16,7 +18,14 @@ LZLookupTable::LZLookupTable(atInt32 minimumMatch, atInt32 slidingWindow, atInt3
 
   setLookAheadWindow(lookAheadWindow);
 
-  m_buffer.reserve(m_minimumMatch);
+  // A link is only overwritten once its position has left the window
+  atUint32 chainSize = 1;
+  while (chainSize < atUint32(m_slidingWindow))
+    chainSize <<= 1;
+  m_chainMask = chainSize - 1;
+  m_chain.resize(chainSize);
+  m_head.resize(1 << HashBits);
+  reset();
 }
 
 LZLookupTable::~LZLookupTable() = default;
@@ -28,6 +37,23 @@ void LZLookupTable::setLookAheadWindow(atInt32 lookAheadWindow) {
     m_lookAheadWindow = 18;
 }
 
+void LZLookupTable::setMaxChainDepth(atInt32 maxChainDepth) { m_maxChainDepth = std::max(maxChainDepth, 0); }
+
+void LZLookupTable::reset() {
+  std::fill(m_head.begin(), m_head.end(), -1);
+  m_dataBegin = nullptr;
+  m_insertPos = 0;
+}
+
+atUint32 LZLookupTable::hash(const atUint8* pos) const {
+  atUint32 key = pos[0];
+  if (m_minimumMatch > 1)
+    key |= atUint32(pos[1]) << 8;
+  if (m_minimumMatch > 2)
+    key |= atUint32(pos[2]) << 16;
+  return (key * 2654435761u) >> (32 - HashBits);
+}
+
 LZLengthOffset LZLookupTable::search(const atUint8* curPos, const atUint8* dataBegin, const atUint8* dataEnd) {
   LZLengthOffset loPair = {0, 0};
 
@@ -37,72 +63,52 @@ LZLengthOffset LZLookupTable::search(const atUint8* curPos, const atUint8* dataB
     return loPair;
   }
 
-  std::copy(curPos, curPos + m_minimumMatch, m_buffer.begin());
-  int32_t currentOffset = static_cast<atInt32>(curPos - dataBegin);
-
-  // Find code
-  if (currentOffset > 0 && (dataEnd - curPos) >= m_minimumMatch) {
-    auto elements = table.equal_range(m_buffer);
-    elements.second--;
-    elements.first--;
-
-    // Iterate over keys in reverse order. C++11 guarantees that the relative order of elements is maintained for the
-    // same key
-    for (auto iter = elements.second; iter != elements.first; iter--) {
-      int32_t matchLength = m_minimumMatch;
-      int32_t lookAheadBufferLength =
-          ((dataEnd - curPos) < m_lookAheadWindow) ? static_cast<int32_t>(dataEnd - curPos) : m_lookAheadWindow;
-
-      for (; matchLength < lookAheadBufferLength; ++matchLength) {
-        if (*(dataBegin + iter->second + matchLength) != *(curPos + matchLength))
-          break;
-      }
-
-      // Store the longest match found so far into length_offset struct.
-      // When lengths are the same the closer offset to the lookahead buffer wins
-      if (loPair.length < (atUint32)matchLength) {
-        loPair.length = matchLength;
-        loPair.offset = currentOffset - iter->second;
-      }
-
-      // Found the longest match so break out of loop
-      if (loPair.length == (atUint32)m_lookAheadWindow)
-        break;
-    }
+  const atInt32 currentOffset = static_cast<atInt32>(curPos - dataBegin);
+  if (dataBegin != m_dataBegin || currentOffset < m_insertPos) {
+    reset();
+    m_dataBegin = dataBegin;
   }
 
-  // end find code
-  // Insert code
-  table.insert(std::make_pair(m_buffer, currentOffset));
-
-  for (atUint32 i = 1; i < loPair.length; i++) {
-    if (dataEnd - (curPos + i) < m_minimumMatch)
-      break;
-
-    std::copy(curPos + i, curPos + m_minimumMatch + i, m_buffer.begin());
-    table.insert(std::make_pair(m_buffer, currentOffset + i));
+  // Link every position up to this one, including those a previous match skipped over
+  const atInt32 lastLinkable = static_cast<atInt32>(dataEnd - dataBegin) - m_minimumMatch;
+  for (atInt32 pos = m_insertPos; pos < currentOffset && pos <= lastLinkable; ++pos) {
+    atInt32& head = m_head[hash(dataBegin + pos)];
+    m_chain[pos & m_chainMask] = head;
+    head = pos;
   }
+  m_insertPos = currentOffset;
 
-  // end insert code
-  // Delete code
-  int32_t slidingWindowOffset = std::max(0, currentOffset - m_slidingWindow); // Absolute offset
-  int32_t tablesize = static_cast<int32_t>(table.size());
-
-  for (int32_t i = 0; i < tablesize - m_slidingWindow; ++i) {
-    std::copy(dataBegin + slidingWindowOffset + i, dataBegin + slidingWindowOffset + m_minimumMatch + i,
-              m_buffer.begin());
-    auto elements = table.equal_range(m_buffer);
+  if (currentOffset > 0 && (dataEnd - curPos) >= m_minimumMatch) {
+    const atInt32 lookAheadBufferLength =
+        ((dataEnd - curPos) < m_lookAheadWindow) ? static_cast<atInt32>(dataEnd - curPos) : m_lookAheadWindow;
+    const atInt32 windowStart = currentOffset - m_slidingWindow;
+    atInt32 depth = m_maxChainDepth;
+
+    for (atInt32 pos = m_head[hash(curPos)]; pos >= 0 && pos >= windowStart; pos = m_chain[pos & m_chainMask]) {
+      const atUint8* candidate = dataBegin + pos;
+
+      // A candidate can only be longer if it also matches the byte the best one stopped at.
+      // Different prefixes sharing a hash come out shorter than the minimum match.
+      const atInt32 matchLength = candidate[loPair.length] == curPos[loPair.length]
+                                      ? lzMatchLength(candidate, curPos, lookAheadBufferLength)
+                                      : 0;
+      if (matchLength >= m_minimumMatch) {
+        // Store the longest match found so far into length_offset struct.
+        // When lengths are the same the closer offset to the lookahead buffer wins
+        if (loPair.length < (atUint32)matchLength) {
+          loPair.length = matchLength;
+          loPair.offset = currentOffset - pos;
+        }
+
+        // Found the longest match so break out of loop
+        if (loPair.length == (atUint32)lookAheadBufferLength)
+          break;
+      }
 
-    for (auto iter = elements.first; iter != elements.second; iter++) {
-      if (slidingWindowOffset + i == iter->second) {
-        table.erase(iter);
-        // There should no occurance of the map with the same value
+      if (depth && --depth == 0)
         break;
-      }
     }
   }
 
-  // end delete code
   return loPair;
-  // break lookupTable.cpp:109 if table.size()> 4096
 }
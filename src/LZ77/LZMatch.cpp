@@ -0,0 +1,137 @@
+#include "LZ77/LZMatch.hpp"
+#include <athena/Utility.hpp>
+#include <cstring>
+
+#if _WIN32
+#include <intrin.h>
+#endif
+
+#if __SSE2__ || _M_X64 || _M_IX86_FP >= 2
+#include <emmintrin.h>
+#define _LZ_SSE2 1
+#endif
+
+#if _LZ_SSE2 && (__x86_64__ || __i386__ || _M_X64 || _M_IX86)
+#define _LZ_DISPATCH 1
+#endif
+
+#if _LZ_DISPATCH
+// Compares whole 32 byte blocks and returns how many bytes match, defined in LZMatchAVX2.cpp.
+// Returns nullptr when that file wasn't built with AVX2 enabled.
+using LZMatchBlocks = atInt32 (*)(const atUint8* str1, const atUint8* str2, atInt32 length);
+LZMatchBlocks lzMatchBlocksAVX2();
+#endif
+
+namespace {
+using Kernel = atInt32 (*)(const atUint8* str1, const atUint8* str2, atInt32 maxLength);
+
+// Index of the first byte that differs given the XOR of two words loaded in memory order
+atInt32 firstDifference(atUint64 diff) {
+#if __GNUC__
+  return (athena::utility::isSystemBigEndian() ? __builtin_clzll(diff) : __builtin_ctzll(diff)) / 8;
+#elif _MSC_VER && (_M_X64 || _M_ARM64)
+  unsigned long index;
+  _BitScanForward64(&index, diff);
+  return atInt32(index / 8);
+#else
+  atInt32 index = 0;
+  while (!(diff & 0xFF)) {
+    diff >>= 8;
+    ++index;
+  }
+  return index;
+#endif
+}
+
+#if _LZ_SSE2
+// Index of the lowest set bit of a nonzero byte mask
+atInt32 firstSetBit(atUint32 mask) {
+#if _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return atInt32(index);
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+atInt32 matchLengthScalar(const atUint8* str1, const atUint8* str2, atInt32 maxLength) {
+  atInt32 len = 0;
+  for (; len + 8 <= maxLength; len += 8) {
+    atUint64 word1, word2;
+    memcpy(&word1, str1 + len, 8);
+    memcpy(&word2, str2 + len, 8);
+    if (word1 != word2)
+      return len + firstDifference(word1 ^ word2);
+  }
+
+  while (len < maxLength && str1[len] == str2[len])
+    ++len;
+  return len;
+}
+
+#if _LZ_SSE2
+atInt32 matchLengthSSE2(const atUint8* str1, const atUint8* str2, atInt32 maxLength) {
+  atInt32 len = 0;
+  for (; len + 16 <= maxLength; len += 16) {
+    const __m128i block1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str1 + len));
+    const __m128i block2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str2 + len));
+    // One bit per byte, set where they differ
+    const atUint32 mask = atUint32(_mm_movemask_epi8(_mm_cmpeq_epi8(block1, block2))) ^ 0xFFFF;
+    if (mask)
+      return len + firstSetBit(mask);
+  }
+
+  return len + matchLengthScalar(str1 + len, str2 + len, maxLength - len);
+}
+#endif
+
+#if _LZ_DISPATCH
+LZMatchBlocks MatchBlocksAVX2 = nullptr;
+
+atInt32 matchLengthAVX2(const atUint8* str1, const atUint8* str2, atInt32 maxLength) {
+  const atInt32 blocks = maxLength & ~31;
+  const atInt32 len = blocks ? MatchBlocksAVX2(str1, str2, blocks) : 0;
+  if (len < blocks)
+    return len;
+
+  return len + matchLengthSSE2(str1 + len, str2 + len, maxLength - len);
+}
+
+bool hasAVX2() {
+#if _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  // The OS has to save the YMM registers too
+  if (!(info[2] & 0x8000000) || (_xgetbv(0) & 0x6) != 0x6)
+    return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & 0x20) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+Kernel selectKernel() {
+#if _LZ_DISPATCH
+  MatchBlocksAVX2 = lzMatchBlocksAVX2();
+  if (MatchBlocksAVX2 && hasAVX2())
+    return matchLengthAVX2;
+#endif
+#if _LZ_SSE2
+  return matchLengthSSE2;
+#else
+  return matchLengthScalar;
+#endif
+}
+} // Anonymous namespace
+
+atInt32 lzMatchLength(const atUint8* str1, const atUint8* str2, atInt32 maxLength) {
+  static const Kernel kernel = selectKernel();
+  return kernel(str1, str2, maxLength);
+}
@@ -0,0 +1,39 @@
+#include <athena/Types.hpp>
+
+// Built with AVX2 enabled, only called once the CPU is known to support it
+#if __AVX2__ || (_MSC_VER && _M_X64)
+#include <immintrin.h>
+#if _WIN32
+#include <intrin.h>
+#endif
+#define _LZ_AVX2 1
+#endif
+
+using LZMatchBlocks = atInt32 (*)(const atUint8* str1, const atUint8* str2, atInt32 length);
+
+#if _LZ_AVX2
+namespace {
+atInt32 matchBlocks(const atUint8* str1, const atUint8* str2, atInt32 length) {
+  for (atInt32 len = 0; len < length; len += 32) {
+    const __m256i block1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str1 + len));
+    const __m256i block2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str2 + len));
+    // One bit per byte, set where they differ
+    const atUint32 mask = ~atUint32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block1, block2)));
+    if (mask) {
+#if _MSC_VER
+      unsigned long index;
+      _BitScanForward(&index, mask);
+      return len + atInt32(index);
+#else
+      return len + __builtin_ctz(mask);
+#endif
+    }
+  }
+  return length;
+}
+} // Anonymous namespace
+
+LZMatchBlocks lzMatchBlocksAVX2() { return matchBlocks; }
+#else
+LZMatchBlocks lzMatchBlocksAVX2() { return nullptr; }
+#endif
@@ -6,7 +6,8 @@
 
 #include "LZ77/LZLookupTable.hpp"
 
-#include <athena/MemoryWriter.hpp>
+#include <athena/Compression.hpp>
+#include <athena/SegmentedWriter.hpp>
 
 LZType10::LZType10(atInt32 MinimumOffset, atInt32 SlidingWindow, atInt32 MinimumMatch, atInt32 BlockSize)
 : LZBase(MinimumOffset, SlidingWindow, MinimumMatch, BlockSize) {
@@ -19,11 +20,13 @@ atUint32 LZType10::compress(const atUint8* src, atUint8** dstBuf, atUint32 srcLe
   atUint32 encodeSize = (srcLength << 8) | (0x10);
   encodeSize = athena::utility::LittleUint32(encodeSize); // File size needs to be written as little endian always
 
-  athena::io::MemoryCopyWriter outbuf("tmp");
+  athena::io::SegmentedWriter outbuf;
   outbuf.writeUint32(encodeSize);
 
   const atUint8* ptrStart = src;
   const atUint8* ptrEnd = src + srcLength;
+  if (m_parseEffort)
+    parseOptimal(src, srcLength);
 
   // At most their will be two bytes written if the bytes can be compressed. So if all bytes in the block can be
   // compressed it would take blockSize*2 bytes
@@ -35,9 +38,9 @@ atUint32 LZType10::compress(const atUint8* src, atUint8** dstBuf, atUint32 srcLe
     // For example 01001000 means that the second and fifth byte in the blockSize from the left is compressed
     atUint8* ptrBytes = compressedBytes.get();
 
-    for (atInt32 i = 0; i < m_blockSize; i++) {
+    for (atInt32 i = 0; i < m_blockSize && ptrStart < ptrEnd; i++) {
       // length_offset searchResult=Search(ptrStart, filedata, ptrEnd);
-      const LZLengthOffset searchResult = m_lookupTable.search(ptrStart, src, ptrEnd);
+      const LZLengthOffset searchResult = nextMatch(ptrStart, src, ptrEnd);
 
       // If the number of bytes to be compressed is at least the size of the Minimum match
       if (searchResult.length >= static_cast<atUint32>(m_minMatch)) {
@@ -69,71 +72,74 @@ atUint32 LZType10::compress(const atUint8* src, atUint8** dstBuf, atUint32 srcLe
   }
 
   *dstBuf = outbuf.data();
-  outbuf.save();
   return static_cast<atUint32>(outbuf.length());
 }
 
+atUint32 LZType10::matchCost(atUint32) const {
+  // A flag bit and a two byte token
+  return 17;
+}
+
 atUint32 LZType10::decompress(const atUint8* src, atUint8** dst, atUint32 srcLength) {
   if (*src != 0x10) {
     return 0;
   }
 
-  // Size of data when it is uncompressed
-  atUint32 uncompressedSize;
-  std::memcpy(&uncompressedSize, src, sizeof(uncompressedSize));
-
-  // The compressed file has the filesize encoded in little endian
-  athena::utility::LittleUint32(uncompressedSize);
-
-  // first byte is the encode flag
-  uncompressedSize = uncompressedSize >> 8;
+  return decompressAllocated(src, dst, srcLength);
+}
 
-  auto uncompressedData = std::unique_ptr<atUint8[]>(new atUint8[uncompressedSize]);
-  atUint8* outputPtr = uncompressedData.get();
-  atUint8* outputEndPtr = uncompressedData.get() + uncompressedSize;
-  const atUint8* inputPtr = src + 4;
-  const atUint8* inputEndPtr = src + srcLength;
+athena::io::Compression::Status LZType10::decompressInto(const atUint8* src, size_t srcLen, atUint8* dst,
+                                                         size_t dstCap, size_t& decompressedLen) const {
+  using athena::io::Compression::Status;
+  decompressedLen = 0;
+  if (srcLen && *src != 0x10)
+    return Status::InvalidData;
 
-  while (inputPtr < inputEndPtr && outputPtr < outputEndPtr) {
+  // Size of data when it is uncompressed
+  size_t uncompressedSize, headerSize;
+  const Status header = readHeader(src, srcLen, uncompressedSize, headerSize);
+  if (header != Status::Ok)
+    return header;
+  if (uncompressedSize > dstCap)
+    return Status::OutputOverrun;
+
+  atUint8* outputPtr = dst;
+  atUint8* outputEndPtr = dst + uncompressedSize;
+  const atUint8* outputLimit = dst + dstCap;
+  const atUint8* inputPtr = src + headerSize;
+  const atUint8* inputEndPtr = src + srcLen;
+
+  while (outputPtr < outputEndPtr) {
+    if (inputPtr == inputEndPtr)
+      return Status::TruncatedInput;
     const atUint8 isCompressed = *inputPtr++;
 
-    for (atUint32 i = 0; i < static_cast<atUint32>(m_blockSize); i++) {
+    for (atUint32 i = 0; i < static_cast<atUint32>(m_blockSize) && outputPtr < outputEndPtr; i++) {
       // Checks to see if the next byte is compressed by looking
       // at its binary representation - E.g 10010000
       // This says that the first extracted byte and the four extracted byte is compressed
-      if ((isCompressed >> (7 - i)) & 0x1) {
-        atUint16 lenOff;
-        memcpy(&lenOff, inputPtr, sizeof(atUint16));
-        athena::utility::BigUint16(lenOff);
-        inputPtr += sizeof(atUint16); // Move forward two bytes
-        // length offset pair has been decoded.
-        LZLengthOffset decoding;
-        decoding.length = (lenOff >> 12) + m_minMatch;
-        decoding.offset = static_cast<atUint16>((lenOff & 0xFFF) + 1);
-
-        if ((outputPtr - decoding.offset) < uncompressedData.get()) {
-          // If the offset to look for uncompressed is passed the current uncompresed data then the data is not
-          // compressed
-          dst = nullptr;
-          return 0;
-        }
-
-        for (size_t j = 0; j < decoding.length; ++j) {
-          outputPtr[j] = (outputPtr - decoding.offset)[j];
-        }
-
-        outputPtr += decoding.length;
-      } else {
+      if (!((isCompressed >> (7 - i)) & 0x1)) {
+        if (inputPtr == inputEndPtr)
+          return Status::TruncatedInput;
         *outputPtr++ = *inputPtr++;
+        continue;
       }
 
-      if (!(inputPtr < inputEndPtr && outputPtr < outputEndPtr)) {
-        break;
-      }
+      if (inputEndPtr - inputPtr < 2)
+        return Status::TruncatedInput;
+      const atUint32 length = (inputPtr[0] >> 4) + m_minMatch;
+      const atUint32 offset = (((inputPtr[0] & 0xF) << 8) | inputPtr[1]) + 1;
+      inputPtr += 2; // Move forward two bytes
+
+      // A match can neither reach back past the start of the data nor run past its end
+      if (offset > static_cast<size_t>(outputPtr - dst) || length > static_cast<size_t>(outputEndPtr - outputPtr))
+        return Status::InvalidData;
+
+      copyMatch(outputPtr, offset, length, outputLimit);
+      outputPtr += length;
     }
   }
 
-  *dst = uncompressedData.release();
-
-  return uncompressedSize;
+  decompressedLen = uncompressedSize;
+  return Status::Ok;
 }
@@ -6,7 +6,16 @@
 
 #include "LZ77/LZLookupTable.hpp"
 
-#include <athena/MemoryWriter.hpp>
+#include <athena/Compression.hpp>
+#include <athena/SegmentedWriter.hpp>
+
+namespace {
+constexpr atUint8 maxTwoByteMatch = 0xF + 1;
+constexpr atUint8 minThreeByteMatch = maxTwoByteMatch + 1; // Minimum Three byte match is maximum TwoByte match + 1
+constexpr atUint16 maxThreeByteMatch = 0xFF + minThreeByteMatch;
+constexpr atUint16 minFourByteMatch = maxThreeByteMatch + 1; // Minimum Four byte match is maximum Three Byte match + 1
+constexpr atInt32 maxFourByteMatch = 0xFFFF + minFourByteMatch;
+} // Anonymous namespace
 
 LZType11::LZType11(atInt32 minimumOffset, atInt32 slidingWindow, atInt32 minimumMatch, atInt32 blockSize)
 : LZBase(minimumOffset, slidingWindow, minimumMatch, blockSize) {
@@ -15,7 +24,7 @@ LZType11::LZType11(atInt32 minimumOffset, atInt32 slidingWindow, atInt32 minimum
 }
 
 atUint32 LZType11::compress(const atUint8* src, atUint8** dst, atUint32 srcLength) {
-  athena::io::MemoryCopyWriter outbuff("tmp");
+  athena::io::SegmentedWriter outbuff;
 
   if (srcLength > 0xFFFFFF) { // If length is greater than 24 bits or 16 Megs
     atUint32 encodeFlag = 0x11;
@@ -31,18 +40,14 @@ atUint32 LZType11::compress(const atUint8* src, atUint8** dst, atUint32 srcLengt
 
   const atUint8* ptrStart = src;
   const atUint8* ptrEnd = src + srcLength;
+  if (m_parseEffort)
+    parseOptimal(src, srcLength);
 
-  // At most their will be two bytes written if the bytes can be compressed. So if all bytes in the block can be
-  // compressed it would take blockSize*2 bytes
+  // At most their will be four bytes written if the bytes can be compressed. So if all bytes in the block can be
+  // compressed it would take blockSize*4 bytes
 
   // Holds the compressed bytes yet to be written
-  auto compressedBytes = std::unique_ptr<atUint8[]>(new atUint8[m_blockSize * 2]);
-
-  const atUint8 maxTwoByteMatch = 0xF + 1;
-  const atUint8 minThreeByteMatch = maxTwoByteMatch + 1; // Minimum Three byte match is maximum TwoByte match + 1
-  const atUint16 maxThreeByteMatch = 0xFF + minThreeByteMatch;
-  const atUint16 minFourByteMatch = maxThreeByteMatch + 1; // Minimum Four byte match is maximum Three Byte match + 1
-  const atInt32 maxFourByteMatch = 0xFFFF + minFourByteMatch;
+  auto compressedBytes = std::unique_ptr<atUint8[]>(new atUint8[m_blockSize * 4]);
 
   /*
   Normaliazation Example: If MIN_MATCH is 3 then 3 gets mapped to 2 and 16 gets mapped to 15.
@@ -64,9 +69,9 @@ atUint32 LZType11::compress(const atUint8* src, atUint8** dst, atUint32 srcLengt
     // For example 01001000 means that the second and fifth byte in the blockSize from the left is compressed
     atUint8* ptrBytes = compressedBytes.get();
 
-    for (atInt32 i = 0; i < m_blockSize; i++) {
+    for (atInt32 i = 0; i < m_blockSize && ptrStart < ptrEnd; i++) {
       // length_offset searchResult=Search(filedata,ptrStart,ptrEnd);
-      const LZLengthOffset searchResult = m_lookupTable.search(ptrStart, src, ptrEnd);
+      const LZLengthOffset searchResult = nextMatch(ptrStart, src, ptrEnd);
 
       // If the number of bytes to be compressed is at least the size of the Minimum match
       if (searchResult.length >= static_cast<atUint32>(m_minMatch)) {
@@ -120,94 +125,87 @@ atUint32 LZType11::compress(const atUint8* src, atUint8** dst, atUint32 srcLengt
   return static_cast<atUint32>(outbuff.length());
 }
 
+atUint32 LZType11::matchCost(atUint32 length) const {
+  // A flag bit and a two, three or four byte token
+  if (length <= maxTwoByteMatch)
+    return 17;
+  if (length <= maxThreeByteMatch)
+    return 25;
+  return 33;
+}
+
 atUint32 LZType11::decompress(const atUint8* src, atUint8** dst, atUint32 srcLength) {
   if (*src != 0x11) {
     return 0;
   }
 
-  atUint32 uncompressedLen;
-  std::memcpy(&uncompressedLen, src, sizeof(uncompressedLen));
-  athena::utility::LittleUint32(uncompressedLen); // The compressed file has the filesize encoded in little endian
-  uncompressedLen = uncompressedLen >> 8;         // First byte is the encode flag
-  atUint32 currentOffset = 4;
-
-  // If the filesize var is zero then the true filesize is over 14MB and must be read in from the next 4 bytes
-  if (uncompressedLen == 0) {
-    atUint32 filesize;
-    std::memcpy(&filesize, src + 4, sizeof(filesize));
-    filesize = athena::utility::LittleUint32(filesize);
-    currentOffset += 4;
-  }
-
-  auto uncompressedData = std::unique_ptr<atUint8[]>(new atUint8[uncompressedLen]);
-  atUint8* outputPtr = uncompressedData.get();
-  atUint8* outputEndPtr = uncompressedData.get() + uncompressedLen;
-  const atUint8* inputPtr = src + currentOffset;
-  const atUint8* inputEndPtr = src + srcLength;
-
-  LZLengthOffset decoding;
-  const atUint8 maxTwoByteMatch = 0xF + 1;
-  const atUint8 threeByteDenorm = maxTwoByteMatch + 1; // Amount to add to length when compression is 3 bytes
-  const atUint16 maxThreeByteMatch = 0xFF + threeByteDenorm;
-  const atUint16 fourByteDenorm = maxThreeByteMatch + 1;
+  return decompressAllocated(src, dst, srcLength);
+}
 
-  while (inputPtr < inputEndPtr && outputPtr < outputEndPtr) {
+athena::io::Compression::Status LZType11::decompressInto(const atUint8* src, size_t srcLen, atUint8* dst,
+                                                         size_t dstCap, size_t& decompressedLen) const {
+  using athena::io::Compression::Status;
+  decompressedLen = 0;
+  if (srcLen && *src != 0x11)
+    return Status::InvalidData;
+
+  // If the 24 bit size is zero the true size is over 16MB and is read from the next 4 bytes
+  size_t uncompressedLen, headerSize;
+  const Status header = readHeader(src, srcLen, uncompressedLen, headerSize);
+  if (header != Status::Ok)
+    return header;
+  if (uncompressedLen > dstCap)
+    return Status::OutputOverrun;
+
+  atUint8* outputPtr = dst;
+  atUint8* outputEndPtr = dst + uncompressedLen;
+  const atUint8* outputLimit = dst + dstCap;
+  const atUint8* inputPtr = src + headerSize;
+  const atUint8* inputEndPtr = src + srcLen;
+
+  while (outputPtr < outputEndPtr) {
+    if (inputPtr == inputEndPtr)
+      return Status::TruncatedInput;
     const atUint8 isCompressed = *inputPtr++;
 
-    for (atInt32 i = 0; i < m_blockSize; i++) {
+    for (atInt32 i = 0; i < m_blockSize && outputPtr < outputEndPtr; i++) {
       // Checks to see if the next byte is compressed by looking
       // at its binary representation - E.g 10010000
       // This says that the first extracted byte and the four extracted byte is compressed
-      if ((isCompressed >> (7 - i)) & 0x1) {
-        const atUint8 metaDataSize = *inputPtr >> 4; // Look at the top 4 bits
-
-        if (metaDataSize >= 2) { // Two Bytes of Length/Offset MetaData
-          atUint16 lenOff = 0;
-          memcpy(&lenOff, inputPtr, 2);
-          inputPtr += 2;
-          athena::utility::BigUint16(lenOff);
-          decoding.length = (lenOff >> 12) + 1;
-          decoding.offset = (lenOff & 0xFFF) + 1;
-        } else if (metaDataSize == 0) { // Three Bytes of Length/Offset MetaData
-          atUint32 lenOff = 0;
-          memcpy(reinterpret_cast<atUint8*>(&lenOff) + 1, inputPtr, 3);
-          inputPtr += 3;
-          athena::utility::BigUint32(lenOff);
-          decoding.length = (lenOff >> 12) + threeByteDenorm;
-          decoding.offset = (lenOff & 0xFFF) + 1;
-        } else if (metaDataSize == 1) { // Four Bytes of Length/Offset MetaData
-          atUint32 lenOff = 0;
-          memcpy(&lenOff, inputPtr, 4);
-          inputPtr += 4;
-          athena::utility::BigUint32(lenOff);
-
-          decoding.length = ((lenOff >> 12) & 0xFFFF) + fourByteDenorm; // Gets rid of the Four byte flag
-          decoding.offset = (lenOff & 0xFFF) + 1;
-        } else {
-          return 0;
-        }
-
-        // If the offset to look for uncompressed is passed the
-        // current uncompresed data then the data is not compressed
-        if ((outputPtr - decoding.offset) < uncompressedData.get()) {
-          return 0;
-        }
-
-        for (size_t j = 0; j < decoding.length; ++j) {
-          outputPtr[j] = (outputPtr - decoding.offset)[j];
-        }
-
-        outputPtr += decoding.length;
-      } else {
+      if (!((isCompressed >> (7 - i)) & 0x1)) {
+        if (inputPtr == inputEndPtr)
+          return Status::TruncatedInput;
         *outputPtr++ = *inputPtr++;
+        continue;
       }
 
-      if (!(inputPtr < inputEndPtr && outputPtr < outputEndPtr)) {
-        break;
+      if (inputPtr == inputEndPtr)
+        return Status::TruncatedInput;
+      const atUint8 metaDataSize = *inputPtr >> 4; // Look at the top 4 bits
+      const size_t tokenSize = metaDataSize >= 2 ? 2 : metaDataSize == 0 ? 3 : 4;
+      if (static_cast<size_t>(inputEndPtr - inputPtr) < tokenSize)
+        return Status::TruncatedInput;
+
+      atUint32 length;
+      if (metaDataSize >= 2) { // Two Bytes of Length/Offset MetaData
+        length = metaDataSize + 1;
+      } else if (metaDataSize == 0) { // Three Bytes of Length/Offset MetaData
+        length = (((inputPtr[0] & 0xF) << 4) | (inputPtr[1] >> 4)) + minThreeByteMatch;
+      } else { // Four Bytes of Length/Offset MetaData
+        length = (((inputPtr[0] & 0xF) << 12) | (inputPtr[1] << 4) | (inputPtr[2] >> 4)) + minFourByteMatch;
       }
+      const atUint32 offset = (((inputPtr[tokenSize - 2] & 0xF) << 8) | inputPtr[tokenSize - 1]) + 1;
+      inputPtr += tokenSize;
+
+      // A match can neither reach back past the start of the data nor run past its end
+      if (offset > static_cast<size_t>(outputPtr - dst) || length > static_cast<size_t>(outputEndPtr - outputPtr))
+        return Status::InvalidData;
+
+      copyMatch(outputPtr, offset, length, outputLimit);
+      outputPtr += length;
     }
   }
 
-  *dst = uncompressedData.release();
-  return uncompressedLen;
+  decompressedLen = uncompressedLen;
+  return Status::Ok;
 }
@@ -8,7 +8,8 @@ namespace athena::io {
 
 ALTTPFileReader::ALTTPFileReader(atUint8* data, atUint64 length) : MemoryCopyReader(data, length) {}
 
-ALTTPFileReader::ALTTPFileReader(const std::string& filename) : MemoryCopyReader(filename) {}
+ALTTPFileReader::ALTTPFileReader(const std::string& filename, bool mapFile)
+: MemoryCopyReader(filename, mapFile ? Load::Map : Load::Copy) {}
 
 ALTTPFile* ALTTPFileReader::readFile() {
   std::vector<ALTTPQuest*> quests;
@@ -0,0 +1,184 @@
+#include "athena/AsyncPrefetchReader.hpp"
+#include "athena/FileReader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace athena::io {
+namespace {
+// Page alignment keeps the buffers friendly to unbuffered/direct I/O sources
+constexpr std::align_val_t BufferAlignment{4096};
+} // Anonymous namespace
+
+AsyncPrefetchReader::AsyncPrefetchReader(std::unique_ptr<IStreamReader>&& source, atUint32 bufferSize,
+                                         atUint32 bufferCount, bool globalErr)
+: m_source(std::move(source)), m_bufferSize(std::max(bufferSize, 1u)), m_globalErr(globalErr) {
+  m_slots.resize(std::max(bufferCount, 2u));
+  start();
+}
+
+AsyncPrefetchReader::AsyncPrefetchReader(std::string_view filename, atUint32 bufferSize, atUint32 bufferCount,
+                                         bool globalErr)
+: m_source(std::make_unique<FileReader>(filename, 0, globalErr))
+, m_bufferSize(std::max(bufferSize, 1u))
+, m_globalErr(globalErr) {
+  m_slots.resize(std::max(bufferCount, 2u));
+  start();
+}
+
+AsyncPrefetchReader::~AsyncPrefetchReader() {
+  if (m_thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lk(m_lock);
+      m_running = false;
+    }
+    m_emptyCv.notify_one();
+    m_thread.join();
+  }
+
+  if (m_storage)
+    ::operator delete(m_storage, BufferAlignment);
+}
+
+void AsyncPrefetchReader::start() {
+  if (!m_source || m_source->hasError()) {
+    if (m_globalErr)
+      atError(fmt("Invalid prefetch source"));
+    setError();
+    return;
+  }
+
+  m_storage = static_cast<atUint8*>(::operator new(size_t(m_bufferSize) * m_slots.size(), BufferAlignment));
+  for (size_t i = 0; i < m_slots.size(); ++i)
+    m_slots[i].data = m_storage + size_t(m_bufferSize) * i;
+
+  m_length = m_source->length();
+  m_position = m_source->position();
+  m_fillOffset = m_position;
+  m_sourceEnd = m_fillOffset >= m_length;
+  // The worker starts out where the source is, before the consumer can move the fill offset
+  m_thread = std::thread(&AsyncPrefetchReader::worker, this, m_fillOffset);
+}
+
+void AsyncPrefetchReader::restart(atUint64 offset) {
+  // Any read in flight belongs to the old generation and is discarded when it lands
+  m_head = 0;
+  m_count = 0;
+  m_fillOffset = offset;
+  m_sourceEnd = offset >= m_length;
+  ++m_generation;
+  m_emptyCv.notify_one();
+}
+
+void AsyncPrefetchReader::restartOutsideWindow() {
+  const atUint64 windowStart = m_count ? m_slots[m_head].offset : m_fillOffset;
+  if (m_position < windowStart || m_position >= windowStart + atUint64(m_bufferSize) * m_slots.size())
+    restart(m_position);
+}
+
+void AsyncPrefetchReader::worker(atUint64 sourcePos) {
+  std::unique_lock<std::mutex> lk(m_lock);
+  while (true) {
+    m_emptyCv.wait(lk, [this]() { return !m_running || (!m_sourceEnd && m_count < m_slots.size()); });
+    if (!m_running)
+      break;
+
+    Slot& slot = m_slots[(m_head + m_count) % m_slots.size()];
+    const atUint64 generation = m_generation;
+    const atUint64 offset = m_fillOffset;
+    lk.unlock();
+
+    if (sourcePos != offset)
+      m_source->seek(offset, SeekOrigin::Begin);
+    atUint64 size = m_source->readUBytesToBuf(slot.data, std::min<atUint64>(m_bufferSize, m_length - offset));
+    sourcePos = offset + size;
+
+    lk.lock();
+    if (generation != m_generation)
+      continue;
+
+    if (size) {
+      slot.offset = offset;
+      slot.size = size;
+      ++m_count;
+      m_fillOffset += size;
+    }
+    if (!size || m_fillOffset >= m_length)
+      m_sourceEnd = true;
+    m_filledCv.notify_one();
+  }
+}
+
+void AsyncPrefetchReader::seek(atInt64 pos, SeekOrigin origin) {
+  atInt64 position = atInt64(m_position);
+  switch (origin) {
+  case SeekOrigin::Begin:
+    position = pos;
+    break;
+  case SeekOrigin::Current:
+    position += pos;
+    break;
+  case SeekOrigin::End:
+    position = atInt64(m_length) - pos;
+    break;
+  }
+
+  if (position < 0 || atUint64(position) > m_length) {
+    if (m_globalErr)
+      atError(fmt("Position {:08X} outside stream bounds "), position);
+    setError();
+    return;
+  }
+
+  m_position = atUint64(position);
+
+  // Stop filling a window the consumer has left
+  if (m_thread.joinable()) {
+    std::lock_guard<std::mutex> lk(m_lock);
+    restartOutsideWindow();
+  }
+}
+
+atUint64 AsyncPrefetchReader::readUBytesToBuf(void* buf, atUint64 len) {
+  if (!m_thread.joinable() || m_position >= m_length)
+    return 0;
+
+  len = std::min(len, m_length - m_position);
+  atUint8* dst = reinterpret_cast<atUint8*>(buf);
+  atUint64 rem = len;
+
+  std::unique_lock<std::mutex> lk(m_lock);
+  while (rem) {
+    // Hand buffers the consumer has moved past back to the worker
+    while (m_count && m_slots[m_head].offset + m_slots[m_head].size <= m_position) {
+      m_head = (m_head + 1) % m_slots.size();
+      --m_count;
+      m_emptyCv.notify_one();
+    }
+
+    restartOutsideWindow();
+
+    if (!m_count) {
+      if (m_sourceEnd)
+        break;
+      m_filledCv.wait(lk, [this]() { return m_count || m_sourceEnd; });
+      continue;
+    }
+
+    // Filled slots are never touched by the worker, so copy without holding the lock
+    const Slot& slot = m_slots[m_head];
+    const atUint64 slotOffset = m_position - slot.offset;
+    const atUint64 copySize = std::min(rem, slot.size - slotOffset);
+    lk.unlock();
+    memcpy(dst, slot.data + slotOffset, copySize);
+    dst += copySize;
+    rem -= copySize;
+    m_position += copySize;
+    lk.lock();
+  }
+
+  return atUint64(dst - reinterpret_cast<atUint8*>(buf));
+}
+
+} // namespace athena::io
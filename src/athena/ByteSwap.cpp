@@ -0,0 +1,143 @@
+#include "athena/Utility.hpp"
+
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)) && !defined(GEKKO) &&       \
+    !defined(__SWITCH__)
+#define AT_SWAP_X86 1
+#include <immintrin.h>
+#if _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if AT_SWAP_X86 && !_MSC_VER
+/* Kernels are compiled for their instruction set individually so the rest of the library keeps its baseline */
+#define AT_TARGET(isa) __attribute__((target(isa)))
+#else
+#define AT_TARGET(isa)
+#endif
+
+namespace athena::utility {
+namespace {
+using SwapFunc = void (*)(atUint8* dst, const atUint8* src, size_t count);
+
+template <size_t Size>
+void swapScalar(atUint8* dst, const atUint8* src, size_t count) {
+  for (size_t i = 0; i < count; ++i, src += Size, dst += Size) {
+    if constexpr (Size == 2) {
+      atUint16 val;
+      memcpy(&val, src, 2);
+      val = swapU16(val);
+      memcpy(dst, &val, 2);
+    } else if constexpr (Size == 4) {
+      atUint32 val;
+      memcpy(&val, src, 4);
+      val = swapU32(val);
+      memcpy(dst, &val, 4);
+    } else {
+      atUint64 val;
+      memcpy(&val, src, 8);
+      val = swapU64(val);
+      memcpy(dst, &val, 8);
+    }
+  }
+}
+
+#if AT_SWAP_X86
+/* pshufb indices reversing each 2, 4 or 8-byte lane; repeated for both 128-bit halves of an AVX2 register */
+alignas(32) constexpr atUint8 ShuffleMasks[3][32] = {
+    {1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14},
+    {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12},
+    {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8},
+};
+
+constexpr size_t maskIndex(size_t size) { return size == 2 ? 0 : size == 4 ? 1 : 2; }
+
+template <size_t Size>
+AT_TARGET("ssse3")
+void swapSSSE3(atUint8* dst, const atUint8* src, size_t count) {
+  const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(ShuffleMasks[maskIndex(Size)]));
+  const size_t bytes = count * Size;
+  size_t i = 0;
+  for (; i + 16 <= bytes; i += 16) {
+    __m128i val = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(val, mask));
+  }
+  swapScalar<Size>(dst + i, src + i, (bytes - i) / Size);
+}
+
+template <size_t Size>
+AT_TARGET("avx2")
+void swapAVX2(atUint8* dst, const atUint8* src, size_t count) {
+  const __m256i mask = _mm256_load_si256(reinterpret_cast<const __m256i*>(ShuffleMasks[maskIndex(Size)]));
+  const size_t bytes = count * Size;
+  size_t i = 0;
+  for (; i + 64 <= bytes; i += 64) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(a, mask));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 32), _mm256_shuffle_epi8(b, mask));
+  }
+  for (; i + 32 <= bytes; i += 32) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(a, mask));
+  }
+  swapScalar<Size>(dst + i, src + i, (bytes - i) / Size);
+}
+
+enum class SwapISA { Scalar, SSSE3, AVX2 };
+
+SwapISA detectISA() {
+#if _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  const int maxLeaf = info[0];
+  __cpuid(info, 1);
+  const bool ssse3 = (info[2] & (1 << 9)) != 0;
+  // AVX2 also needs the OS to save the upper register halves
+  const bool osAVX = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+  bool avx2 = false;
+  if (osAVX && maxLeaf >= 7) {
+    __cpuidex(info, 7, 0);
+    avx2 = (info[1] & (1 << 5)) != 0;
+  }
+#else
+  __builtin_cpu_init();
+  const bool ssse3 = __builtin_cpu_supports("ssse3");
+  const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+  return avx2 ? SwapISA::AVX2 : ssse3 ? SwapISA::SSSE3 : SwapISA::Scalar;
+}
+#endif
+
+template <size_t Size>
+SwapFunc selectSwap() {
+#if AT_SWAP_X86
+  static const SwapISA isa = detectISA();
+  switch (isa) {
+  case SwapISA::AVX2:
+    return swapAVX2<Size>;
+  case SwapISA::SSSE3:
+    return swapSSSE3<Size>;
+  default:
+    break;
+  }
+#endif
+  return swapScalar<Size>;
+}
+
+template <size_t Size>
+void swapDispatch(void* dst, const void* src, size_t count) {
+  static const SwapFunc func = selectSwap<Size>();
+  func(static_cast<atUint8*>(dst), static_cast<const atUint8*>(src), count);
+}
+} // Anonymous namespace
+
+void swapArray16(void* dst, const void* src, size_t count) { swapDispatch<2>(dst, src, count); }
+
+void swapArray32(void* dst, const void* src, size_t count) { swapDispatch<4>(dst, src, count); }
+
+void swapArray64(void* dst, const void* src, size_t count) { swapDispatch<8>(dst, src, count); }
+
+} // namespace athena::utility
@@ -1,8 +1,187 @@
 #include "athena/Checksums.hpp"
 
+#include <cstddef>
+
+#if _WIN32
+#include <intrin.h>
+#endif
+
+#if __x86_64__ || __i386__ || _M_X64 || _M_IX86
+#define _CRC_DISPATCH 1
+#endif
+
+#if _CRC_DISPATCH
+// Fold whole 16 byte blocks down to a single block with the same checksum using carry-less multiplies, defined in
+// ChecksumsPCLMUL.cpp and ChecksumsVPCLMUL.cpp. They return nullptr when those files weren't built with the
+// instructions enabled.
+using CrcFold = void (*)(const atUint8* data, atUint64 length, atUint64 seed, const atUint64 (*multipliers)[2],
+                         atUint8* folded);
+CrcFold crcFoldPCLMUL(bool reflected);
+CrcFold crcFoldVPCLMUL(bool reflected);
+#endif
+
 namespace athena::checksums {
+namespace {
+/* The table for each byte position of a block, slice k holds the checksum of a byte followed by k zero bytes */
+template <typename T, size_t Slices>
+struct CrcTables {
+  T slice[Slices][256];
+};
+
+template <typename T, bool Reflected, size_t Slices>
+constexpr CrcTables<T, Slices> makeTables(const T (&table)[256]) {
+  constexpr unsigned Bits = sizeof(T) * 8;
+  CrcTables<T, Slices> ret{};
+  for (size_t i = 0; i < 256; ++i)
+    ret.slice[0][i] = table[i];
+  for (size_t k = 1; k < Slices; ++k) {
+    for (size_t i = 0; i < 256; ++i) {
+      const T prev = ret.slice[k - 1][i];
+      ret.slice[k][i] = Reflected ? T((prev >> 8) ^ table[prev & 0xFF]) : T((prev << 8) ^ table[prev >> (Bits - 8)]);
+    }
+  }
+  return ret;
+}
+
+/* Slicing-by-N: a whole block is looked up at once, every byte in the table for its distance from the block's end.
+ * The running checksum is folded into the block's first bytes, lowest byte first when reflected. */
+template <bool Reflected, typename T, size_t Slices>
+T crcUpdate(const CrcTables<T, Slices>& tables, T checksum, const atUint8* data, atUint64 length) {
+  static_assert(sizeof(T) <= Slices, "The checksum must fit in a block");
+  constexpr unsigned Bits = sizeof(T) * 8;
+
+  for (; length >= Slices; data += Slices, length -= Slices) {
+    T word = checksum;
+    for (size_t i = 0; i < sizeof(T); ++i)
+      word ^= T(data[i]) << (Reflected ? 8 * i : Bits - 8 - 8 * i);
+
+    T next = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+      next ^= tables.slice[Slices - 1 - i][atUint8(word >> (Reflected ? 8 * i : Bits - 8 - 8 * i))];
+    for (size_t i = sizeof(T); i < Slices; ++i)
+      next ^= tables.slice[Slices - 1 - i][data[i]];
+    checksum = next;
+  }
+
+  const T* table = tables.slice[0];
+  for (; length; ++data, --length) {
+    if (Reflected)
+      checksum = T((checksum >> 8) ^ table[(checksum ^ *data) & 0xFF]);
+    else
+      checksum = T(table[((checksum >> (Bits - 8)) ^ *data) & 0xFF] ^ (checksum << 8));
+  }
+  return checksum;
+}
+
+#if _CRC_DISPATCH
+/* x^n modulo the polynomial, which is given without its top bit and not reflected */
+template <typename T>
+constexpr T xPowMod(T poly, unsigned n) {
+  constexpr unsigned Bits = sizeof(T) * 8;
+  T ret = 1;
+  for (; n; --n)
+    ret = (ret >> (Bits - 1)) ? T((ret << 1) ^ poly) : T(ret << 1);
+  return ret;
+}
+
+constexpr atUint64 reverseBits(atUint64 v) {
+  atUint64 ret = 0;
+  for (int i = 0; i < 64; ++i, v >>= 1)
+    ret = (ret << 1) | (v & 1);
+  return ret;
+}
+
+/* Move a block 128, 256, 384, 512 or 2048 bits further along the message, by multiplying its halves by
+ * x^D and x^(D + 64) mod the polynomial. Reflected multipliers are bit reversed, and one power of x short to make up
+ * for the reversed product coming out a bit lower. */
+struct FoldMultipliers {
+  atUint64 k[5][2];
+};
+
+template <typename T, bool Reflected>
+constexpr FoldMultipliers makeFoldMultipliers(T poly) {
+  constexpr unsigned Distances[] = {128, 256, 384, 512, 2048};
+  FoldMultipliers ret{};
+  for (size_t i = 0; i < 5; ++i) {
+    if (Reflected) {
+      ret.k[i][0] = reverseBits(xPowMod(poly, Distances[i] + 63));
+      ret.k[i][1] = reverseBits(xPowMod(poly, Distances[i] - 1));
+    } else {
+      ret.k[i][0] = xPowMod(poly, Distances[i]);
+      ret.k[i][1] = xPowMod(poly, Distances[i] + 64);
+    }
+  }
+  return ret;
+}
+
+bool hasPCLMUL() {
+#if _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  // SSSE3 and PCLMULQDQ
+  return (info[2] & 0x202) == 0x202;
+#else
+  return __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("pclmul");
+#endif
+}
+
+bool hasVPCLMUL() {
+#if _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  // The OS has to save the opmask and ZMM registers too
+  if (!(info[2] & 0x8000000) || (_xgetbv(0) & 0xE6) != 0xE6)
+    return false;
+  __cpuidex(info, 7, 0);
+  // AVX-512 F and BW, then VPCLMULQDQ
+  return (info[1] & 0x40010000) == 0x40010000 && (info[2] & 0x400);
+#else
+  return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+         __builtin_cpu_supports("vpclmulqdq");
+#endif
+}
+
+/* Folding pays for itself from a few blocks on, the wide version needs 16 of them to start with */
+struct CrcFolds {
+  static constexpr atUint64 NarrowMin = 64;
+  static constexpr atUint64 WideMin = 512;
+  CrcFold narrow = nullptr;
+  CrcFold wide = nullptr;
+};
+
+CrcFolds selectFolds(bool reflected) {
+  CrcFolds ret;
+  if (hasPCLMUL())
+    ret.narrow = crcFoldPCLMUL(reflected);
+  if (ret.narrow && hasVPCLMUL())
+    ret.wide = crcFoldVPCLMUL(reflected);
+  return ret;
+}
+
+/* Folds all whole blocks when the CPU can, leaving a single block and the remaining bytes to the tables */
+template <bool Reflected, typename T, size_t Slices>
+T crcFold(const CrcFolds& folds, const FoldMultipliers& multipliers, const CrcTables<T, Slices>& tables, T checksum,
+          const atUint8* data, atUint64 length) {
+  const atUint64 blocks = length & ~atUint64(15);
+  const CrcFold fold = blocks >= CrcFolds::WideMin && folds.wide     ? folds.wide
+                       : blocks >= CrcFolds::NarrowMin && folds.narrow ? folds.narrow
+                                                                       : nullptr;
+  if (!fold)
+    return crcUpdate<Reflected>(tables, checksum, data, length);
+
+  atUint8 folded[16];
+  fold(data, blocks, checksum, multipliers.k, folded);
+  checksum = crcUpdate<Reflected>(tables, T(0), folded, 16);
+  return crcUpdate<Reflected>(tables, checksum, data + blocks, length - blocks);
+}
+#endif
+} // Anonymous namespace
+
 atUint64 crc64(const atUint8* data, atUint64 length, atUint64 seed, atUint64 final) {
-  static const atUint64 crc64Table[256] = {
+  static constexpr atUint64 crc64Table[256] = {
       0x0000000000000000, 0x42F0E1EBA9EA3693, 0x85E1C3D753D46D26, 0xC711223CFA3E5BB5, 0x493366450E42ECDF,
       0x0BC387AEA7A8DA4C, 0xCCD2A5925D9681F9, 0x8E224479F47CB76A, 0x9266CC8A1C85D9BE, 0xD0962D61B56FEF2D,
       0x17870F5D4F51B498, 0x5577EEB6E6BB820B, 0xDB55AACF12C73561, 0x99A54B24BB2D03F2, 0x5EB4691841135847,
@@ -60,17 +239,18 @@ atUint64 crc64(const atUint8* data, atUint64 length, atUint64 seed, atUint64 fin
   if (!data)
     return seed;
 
-  atUint64 checksum = seed;
-  int pos = 0;
-
-  while (length--)
-    checksum = crc64Table[((checksum >> 56) ^ data[pos++]) & 0xff] ^ (checksum << 8);
-
-  return checksum ^ final;
+  static constexpr auto crc64Tables = makeTables<atUint64, false, 16>(crc64Table);
+#if _CRC_DISPATCH
+  static constexpr auto crc64Multipliers = makeFoldMultipliers<atUint64, false>(crc64Table[1]);
+  static const CrcFolds folds = selectFolds(false);
+  return crcFold<false>(folds, crc64Multipliers, crc64Tables, seed, data, length) ^ final;
+#else
+  return crcUpdate<false>(crc64Tables, seed, data, length) ^ final;
+#endif
 }
 
 atUint32 crc32(const atUint8* data, atUint64 length, atUint32 seed, atUint32 final) {
-  static const atUint32 crc32Table[256] = {
+  static constexpr atUint32 crc32Table[256] = {
       0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F, 0xE963A535, 0x9E6495A3, 0x0EDB8832,
       0x79DCB8A4, 0xE0D5E91E, 0x97D2D988, 0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91, 0x1DB71064, 0x6AB020F2,
       0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7, 0x136C9856, 0x646BA8C0, 0xFD62F97A,
@@ -104,17 +284,19 @@ atUint32 crc32(const atUint8* data, atUint64 length, atUint32 seed, atUint32 fin
   if (!data)
     return seed;
 
-  atUint32 checksum = seed;
-  int pos = 0;
-
-  while (length--)
-    checksum = (checksum >> 8) ^ crc32Table[(checksum & 0xFF) ^ data[pos++]];
-
-  return checksum ^ final;
+  static constexpr auto crc32Tables = makeTables<atUint32, true, 16>(crc32Table);
+#if _CRC_DISPATCH
+  // The table is reflected, the multipliers want the polynomial the usual way round
+  static constexpr auto crc32Multipliers = makeFoldMultipliers<atUint32, true>(0x04C11DB7);
+  static const CrcFolds folds = selectFolds(true);
+  return crcFold<true>(folds, crc32Multipliers, crc32Tables, seed, data, length) ^ final;
+#else
+  return crcUpdate<true>(crc32Tables, seed, data, length) ^ final;
+#endif
 }
 
 atUint16 crc16CCITT(const atUint8* data, atUint64 length, atUint16 seed, atUint16 final) {
-  static const atUint16 crc16CCITTTable[256] = {
+  static constexpr atUint16 crc16CCITTTable[256] = {
       0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7, 0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad,
       0xe1ce, 0xf1ef, 0x1231, 0x0210, 0x3273, 0x2252, 0x52b5, 0x4294, 0x72f7, 0x62d6, 0x9339, 0x8318, 0xb37b, 0xa35a,
       0xd3bd, 0xc39c, 0xf3ff, 0xe3de, 0x2462, 0x3443, 0x0420, 0x1401, 0x64e6, 0x74c7, 0x44a4, 0x5485, 0xa56a, 0xb54b,
@@ -135,21 +317,16 @@ atUint16 crc16CCITT(const atUint8* data, atUint64 length, atUint16 seed, atUint1
       0x1ce0, 0x0cc1, 0xef1f, 0xff3e, 0xcf5d, 0xdf7c, 0xaf9b, 0xbfba, 0x8fd9, 0x9ff8, 0x6e17, 0x7e36, 0x4e55, 0x5e74,
       0x2e93, 0x3eb2, 0x0ed1, 0x1ef0};
 
-  atUint16 checksum = seed;
-  int pos = 0;
-
-  while (length--)
-    checksum = crc16CCITTTable[(data[pos++] ^ (checksum >> 8)) & 0xFF] ^ (checksum << 8);
-
-  return checksum ^ final;
+  static constexpr auto crc16CCITTTables = makeTables<atUint16, false, 16>(crc16CCITTTable);
+  return crcUpdate<false>(crc16CCITTTables, seed, data, length) ^ final;
 }
 
-atUint16 crc16(const atUint8* data, atUint64 length, atUint16 seed, atUint64 final) {
+atUint16 crc16(const atUint8* data, atUint64 length, atUint16 seed, atUint16 final) {
   if (data == nullptr) {
     return seed;
   }
 
-  static const atUint16 crc16Table[256] = {
+  static constexpr atUint16 crc16Table[256] = {
       0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241, 0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1,
       0xC481, 0x0440, 0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40, 0x0A00, 0xCAC1, 0xCB81, 0x0B40,
       0xC901, 0x09C0, 0x0880, 0xC841, 0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40, 0x1E00, 0xDEC1,
@@ -170,13 +347,8 @@ atUint16 crc16(const atUint8* data, atUint64 length, atUint16 seed, atUint64 fin
       0x4C80, 0x8C41, 0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641, 0x8201, 0x42C0, 0x4380, 0x8341,
       0x4100, 0x81C1, 0x8081, 0x4040};
 
-  atInt32 pos = 0;
-  atUint16 checksum = seed;
-
-  while (length--)
-    checksum = (crc16Table[(checksum ^ data[pos++]) & 0xFF] ^ (checksum >> 8));
-
-  return checksum ^ final;
+  static constexpr auto crc16Tables = makeTables<atUint16, true, 16>(crc16Table);
+  return crcUpdate<true>(crc16Tables, seed, data, length) ^ final;
 }
 
 } // namespace athena::checksums
@@ -0,0 +1,70 @@
+#include <athena/Types.hpp>
+
+// Built with PCLMULQDQ and SSSE3 enabled, only called once the CPU is known to support them
+#if (__PCLMUL__ && __SSSE3__) || (_MSC_VER && _M_X64)
+#include <immintrin.h>
+#if _WIN32
+#include <intrin.h>
+#endif
+#define _CRC_PCLMUL 1
+#endif
+
+using CrcFold = void (*)(const atUint8* data, atUint64 length, atUint64 seed, const atUint64 (*multipliers)[2],
+                         atUint8* folded);
+
+#if _CRC_PCLMUL
+namespace {
+enum { Fold128, Fold256, Fold384, Fold512 };
+
+/* Moves a block the multiplier's distance further along the message, it is then XORed with the block there */
+__m128i fold(__m128i block, __m128i multiplier) {
+  return _mm_xor_si128(_mm_clmulepi64_si128(block, multiplier, 0x00), _mm_clmulepi64_si128(block, multiplier, 0x11));
+}
+
+/* Non-reflected checksums want the first byte of a block in its top bits */
+template <bool Reflected>
+__m128i load(const atUint8* data) {
+  const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  if (Reflected)
+    return block;
+  return _mm_shuffle_epi8(block, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+template <bool Reflected>
+void foldBlocks(const atUint8* data, atUint64 length, atUint64 seed, const atUint64 (*multipliers)[2],
+                atUint8* folded) {
+  const __m128i* k = reinterpret_cast<const __m128i*>(multipliers);
+  const atUint8* end = data + length;
+  __m128i x0 = _mm_xor_si128(load<Reflected>(data),
+                             Reflected ? _mm_set_epi64x(0, atInt64(seed)) : _mm_set_epi64x(atInt64(seed), 0));
+  data += 16;
+
+  if (length >= 64) {
+    __m128i x1 = load<Reflected>(data);
+    __m128i x2 = load<Reflected>(data + 16);
+    __m128i x3 = load<Reflected>(data + 32);
+    const __m128i k512 = _mm_loadu_si128(k + Fold512);
+    for (data += 48; data + 64 <= end; data += 64) {
+      x0 = _mm_xor_si128(fold(x0, k512), load<Reflected>(data));
+      x1 = _mm_xor_si128(fold(x1, k512), load<Reflected>(data + 16));
+      x2 = _mm_xor_si128(fold(x2, k512), load<Reflected>(data + 32));
+      x3 = _mm_xor_si128(fold(x3, k512), load<Reflected>(data + 48));
+    }
+    x0 = _mm_xor_si128(_mm_xor_si128(fold(x0, _mm_loadu_si128(k + Fold384)), fold(x1, _mm_loadu_si128(k + Fold256))),
+                       _mm_xor_si128(fold(x2, _mm_loadu_si128(k + Fold128)), x3));
+  }
+
+  const __m128i k128 = _mm_loadu_si128(k + Fold128);
+  for (; data < end; data += 16)
+    x0 = _mm_xor_si128(fold(x0, k128), load<Reflected>(data));
+
+  if (!Reflected)
+    x0 = _mm_shuffle_epi8(x0, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(folded), x0);
+}
+} // Anonymous namespace
+
+CrcFold crcFoldPCLMUL(bool reflected) { return reflected ? foldBlocks<true> : foldBlocks<false>; }
+#else
+CrcFold crcFoldPCLMUL(bool) { return nullptr; }
+#endif
@@ -0,0 +1,101 @@
+#include <athena/Types.hpp>
+
+// Built with AVX-512 and VPCLMULQDQ enabled, only called once the CPU is known to support them
+#if (__VPCLMULQDQ__ && __AVX512BW__ && __PCLMUL__) || (_MSC_VER >= 1920 && _M_X64)
+// GCC's AVX-512 headers pass _mm512_undefined_epi32() as the unused merge source of the broadcast and extract
+// intrinsics, which GCC 12 then reports as uninitialized wherever they are inlined
+#if __GNUC__ && !__clang__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#if _WIN32
+#include <intrin.h>
+#endif
+#define _CRC_VPCLMUL 1
+#endif
+
+using CrcFold = void (*)(const atUint8* data, atUint64 length, atUint64 seed, const atUint64 (*multipliers)[2],
+                         atUint8* folded);
+
+#if _CRC_VPCLMUL
+namespace {
+enum { Fold128, Fold256, Fold384, Fold512, Fold2048 };
+
+__m128i fold(__m128i block, __m128i multiplier) {
+  return _mm_xor_si128(_mm_clmulepi64_si128(block, multiplier, 0x00), _mm_clmulepi64_si128(block, multiplier, 0x11));
+}
+
+/* Folds the four blocks of a lane at once */
+__m512i fold(__m512i lane, __m512i multiplier) {
+  return _mm512_xor_si512(_mm512_clmulepi64_epi128(lane, multiplier, 0x00),
+                          _mm512_clmulepi64_epi128(lane, multiplier, 0x11));
+}
+
+__m512i multiplier(const atUint64 (*multipliers)[2], int distance) {
+  return _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(multipliers[distance])));
+}
+
+/* Non-reflected checksums want the first byte of each block in its top bits */
+template <bool Reflected>
+__m512i load(const atUint8* data) {
+  const __m512i lane = _mm512_loadu_si512(data);
+  if (Reflected)
+    return lane;
+  return _mm512_shuffle_epi8(lane, _mm512_broadcast_i32x4(_mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13,
+                                                                       14, 15)));
+}
+
+/* Same as the PCLMULQDQ version, but keeps 16 blocks in flight; length must be at least 256 */
+template <bool Reflected>
+void foldBlocks(const atUint8* data, atUint64 length, atUint64 seed, const atUint64 (*multipliers)[2],
+                atUint8* folded) {
+  const atUint8* end = data + length;
+  const __m128i seedBlock = Reflected ? _mm_set_epi64x(0, atInt64(seed)) : _mm_set_epi64x(atInt64(seed), 0);
+  __m512i z0 = _mm512_xor_si512(load<Reflected>(data), _mm512_inserti32x4(_mm512_setzero_si512(), seedBlock, 0));
+  __m512i z1 = load<Reflected>(data + 64);
+  __m512i z2 = load<Reflected>(data + 128);
+  __m512i z3 = load<Reflected>(data + 192);
+
+  const __m512i k2048 = multiplier(multipliers, Fold2048);
+  for (data += 256; data + 256 <= end; data += 256) {
+    z0 = _mm512_xor_si512(fold(z0, k2048), load<Reflected>(data));
+    z1 = _mm512_xor_si512(fold(z1, k2048), load<Reflected>(data + 64));
+    z2 = _mm512_xor_si512(fold(z2, k2048), load<Reflected>(data + 128));
+    z3 = _mm512_xor_si512(fold(z3, k2048), load<Reflected>(data + 192));
+  }
+
+  const __m512i k512 = multiplier(multipliers, Fold512);
+  z1 = _mm512_xor_si512(fold(z0, k512), z1);
+  z2 = _mm512_xor_si512(fold(z1, k512), z2);
+  z3 = _mm512_xor_si512(fold(z2, k512), z3);
+
+  const __m128i* k = reinterpret_cast<const __m128i*>(multipliers);
+  const __m128i k128 = _mm_loadu_si128(k + Fold128);
+  __m128i x0 = _mm_xor_si128(
+      _mm_xor_si128(fold(_mm512_extracti32x4_epi32(z3, 0), _mm_loadu_si128(k + Fold384)),
+                    fold(_mm512_extracti32x4_epi32(z3, 1), _mm_loadu_si128(k + Fold256))),
+      _mm_xor_si128(fold(_mm512_extracti32x4_epi32(z3, 2), k128), _mm512_extracti32x4_epi32(z3, 3)));
+
+  for (; data < end; data += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    if (!Reflected)
+      block = _mm_shuffle_epi8(block, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    x0 = _mm_xor_si128(fold(x0, k128), block);
+  }
+
+  if (!Reflected)
+    x0 = _mm_shuffle_epi8(x0, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(folded), x0);
+}
+} // Anonymous namespace
+
+CrcFold crcFoldVPCLMUL(bool reflected) { return reflected ? foldBlocks<true> : foldBlocks<false>; }
+
+#if __GNUC__ && !__clang__
+#pragma GCC diagnostic pop
+#endif
+#else
+CrcFold crcFoldVPCLMUL(bool) { return nullptr; }
+#endif
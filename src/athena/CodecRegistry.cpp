@@ -0,0 +1,409 @@
+#include "athena/CodecRegistry.hpp"
+#include "athena/Compression.hpp"
+#include "athena/DecompressReader.hpp"
+#include "athena/ParallelFor.hpp"
+#include "athena/Utility.hpp"
+#include "athena/ZlibStream.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include <zlib.h>
+
+namespace athena::io::Compression {
+namespace {
+// Deflate can't do better than about 1032:1, which bounds what a gzip size field may claim
+constexpr atUint64 DeflateMaxRatio = 1032;
+
+// LZO lengths grow by at most 255 per input byte, which bounds how far its output is grown
+constexpr atUint64 LZOMaxRatio = 256;
+
+// A three byte Yaz0 token copies at most 0x111 bytes, which bounds what its size field may claim
+constexpr atUint64 Yaz0MaxRatio = 92;
+
+// Likewise a two byte LZ10 token copies at most 0x12 bytes and a four byte LZ11 token 0x10110
+constexpr atUint64 LZ10MaxRatio = 9;
+constexpr atUint64 LZ11MaxRatio = 16452;
+
+// How much of the input autoCompress times each codec on
+constexpr size_t SampleSize = 0x10000;
+
+// LZ77 chain depth used at the lowest level
+constexpr atInt32 LZ77FastChainDepth = 16;
+
+class ZlibFormat : public Codec {
+public:
+  explicit ZlibFormat(bool gzip) : m_gzip(gzip) {}
+
+  CodecType type() const override { return m_gzip ? CodecType::Gzip : CodecType::Zlib; }
+  std::string_view name() const override { return m_gzip ? "gzip" : "zlib"; }
+  atInt32 minLevel() const override { return 0; }
+  atInt32 maxLevel() const override { return ZlibBestCompression; }
+  atInt32 defaultLevel() const override { return ZlibBestCompression; }
+
+  bool matches(const atUint8* src, size_t srcLen) const override {
+    if (m_gzip)
+      return srcLen >= 18 && src[0] == 0x1F && src[1] == 0x8B && src[2] == Z_DEFLATED;
+
+    // Deflate with at most a 32 KiB window, no preset dictionary and a valid check value
+    return srcLen >= 6 && (src[0] & 0x0F) == Z_DEFLATED && (src[0] >> 4) <= 7 && (src[1] & 0x20) == 0 &&
+           ((src[0] << 8) | src[1]) % 31 == 0;
+  }
+
+  bool peekSize(const atUint8* src, size_t srcLen, atUint64& size) const override {
+    // Only gzip records the size, modulo 2^32, in its trailer
+    if (!m_gzip || !matches(src, srcLen))
+      return false;
+    const atUint8* trailer = src + srcLen - 4;
+    size = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | (atUint32(trailer[3]) << 24);
+    return true;
+  }
+
+  bool compress(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst, atInt32 level) const override {
+    if (srcLen > UINT_MAX / 2)
+      return false;
+
+    ZlibCompressor& compressor = threadCompressor();
+    compressor.setLevel(level);
+    // The gzip header and trailer are 12 bytes longer than zlib's
+    dst.resize(compressBound(uLong(srcLen)) + 12);
+    const atInt32 ret = compressor.compress(src, atUint32(srcLen), dst.data(), atUint32(dst.size()));
+    if (ret <= 0)
+      return false;
+    dst.resize(size_t(ret));
+    return true;
+  }
+
+  bool decompress(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst) const override {
+    z_stream strm = {};
+    if (inflateInit2(&strm, m_gzip ? MAX_WBITS | 16 : MAX_WBITS) != Z_OK)
+      return false;
+
+    // Start from the recorded size when there is one, growing as needed
+    atUint64 size = 0;
+    if (!peekSize(src, srcLen, size))
+      size = atUint64(srcLen) * 4;
+    dst.resize(size_t(std::clamp<atUint64>(size, 0x100, atUint64(srcLen) * DeflateMaxRatio + 0x100)));
+
+    strm.next_in = const_cast<Bytef*>(src);
+    size_t inLeft = srcLen;
+    size_t produced = 0;
+    atInt32 ret = Z_OK;
+    while (ret != Z_STREAM_END) {
+      if (produced == dst.size())
+        dst.resize(dst.size() * 2);
+
+      strm.avail_in = uInt(std::min<size_t>(inLeft, UINT_MAX));
+      strm.next_out = dst.data() + produced;
+      strm.avail_out = uInt(std::min<size_t>(dst.size() - produced, UINT_MAX));
+      const uInt availIn = strm.avail_in;
+      const uInt availOut = strm.avail_out;
+      ret = inflate(&strm, Z_NO_FLUSH);
+      inLeft -= availIn - strm.avail_in;
+      produced += availOut - strm.avail_out;
+
+      // Without progress the data is either truncated or corrupt
+      if ((ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) ||
+          (ret == Z_BUF_ERROR && inLeft == 0 && strm.avail_out != 0))
+        break;
+    }
+
+    inflateEnd(&strm);
+    if (ret != Z_STREAM_END)
+      return false;
+    dst.resize(produced);
+    return true;
+  }
+
+  std::unique_ptr<IStreamReader> openReader(std::unique_ptr<IStreamReader>&& source) const override {
+    return std::make_unique<ZlibReader>(std::move(source), m_gzip ? MAX_WBITS | 16 : MAX_WBITS);
+  }
+
+  std::unique_ptr<IStreamWriter> openWriter(std::unique_ptr<IStreamWriter>&& destination,
+                                            atInt32 level) const override {
+    return std::make_unique<ZlibWriter>(std::move(destination), level, m_gzip ? MAX_WBITS | 16 : MAX_WBITS);
+  }
+
+private:
+  ZlibCompressor& threadCompressor() const {
+    if (m_gzip) {
+      thread_local ZlibCompressor compressor(ZlibBestCompression, MAX_WBITS | 16);
+      return compressor;
+    }
+    thread_local ZlibCompressor compressor(ZlibBestCompression, MAX_WBITS);
+    return compressor;
+  }
+
+  bool m_gzip;
+};
+
+class Yaz0Format : public Codec {
+public:
+  CodecType type() const override { return CodecType::Yaz0; }
+  std::string_view name() const override { return "yaz0"; }
+  atInt32 minLevel() const override { return atInt32(Yaz0Encoder::Level::Fast); }
+  atInt32 maxLevel() const override { return atInt32(Yaz0Encoder::Level::Optimal); }
+  atInt32 defaultLevel() const override { return atInt32(Yaz0Encoder::Level::Nintendo); }
+
+  bool matches(const atUint8* src, size_t srcLen) const override {
+    atUint64 size;
+    return yaz0PeekHeader(src, srcLen, size) == Status::Ok;
+  }
+
+  bool peekSize(const atUint8* src, size_t srcLen, atUint64& size) const override {
+    return yaz0PeekHeader(src, srcLen, size) == Status::Ok;
+  }
+
+  bool compress(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst, atInt32 level) const override {
+    if (srcLen > (UINT_MAX - Yaz0HeaderSize) / 9 * 8)
+      return false;
+
+    thread_local Yaz0Encoder encoder;
+    encoder.setLevel(Yaz0Encoder::Level(std::clamp(level, minLevel(), maxLevel())));
+
+    const atUint32 size = atUint32(srcLen);
+    dst.resize(Yaz0HeaderSize + Yaz0Encoder::maxEncodedSize(size));
+    memset(dst.data(), 0, Yaz0HeaderSize);
+    memcpy(dst.data(), "Yaz0", 4);
+    atUint32 bigSize = size;
+    utility::BigUint32(bigSize);
+    memcpy(dst.data() + 4, &bigSize, 4);
+    dst.resize(Yaz0HeaderSize + encoder.encode(src, size, dst.data() + Yaz0HeaderSize));
+    return true;
+  }
+
+  bool decompress(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst) const override {
+    atUint64 size;
+    if (!peekSize(src, srcLen, size) || size > atUint64(srcLen) * Yaz0MaxRatio)
+      return false;
+    dst.resize(size_t(size));
+    size_t decodedLen;
+    return yaz0Decode(src + Yaz0HeaderSize, srcLen - Yaz0HeaderSize, dst.data(), dst.size(), decodedLen) == Status::Ok;
+  }
+
+  std::unique_ptr<IStreamReader> openReader(std::unique_ptr<IStreamReader>&& source) const override {
+    return std::make_unique<Yaz0Reader>(std::move(source));
+  }
+};
+
+class LZ77Format : public Codec {
+public:
+  explicit LZ77Format(bool extended) : m_extended(extended) {}
+
+  CodecType type() const override { return m_extended ? CodecType::LZ11 : CodecType::LZ10; }
+  std::string_view name() const override { return m_extended ? "lz11" : "lz10"; }
+  atInt32 minLevel() const override { return 0; }
+  // Level 0 searches fewer matches, 1 takes the longest match everywhere, above that the parse is optimized
+  atInt32 maxLevel() const override { return 1 + LZBase::MaxParseEffort; }
+  atInt32 defaultLevel() const override { return 1; }
+
+  bool matches(const atUint8* src, size_t srcLen) const override {
+    return srcLen >= 4 && src[0] == (m_extended ? 0x11 : 0x10);
+  }
+
+  bool peekSize(const atUint8* src, size_t srcLen, atUint64& size) const override {
+    size_t decompressedSize, headerSize;
+    if (!matches(src, srcLen) || LZBase::readHeader(src, srcLen, decompressedSize, headerSize) != Status::Ok)
+      return false;
+    size = decompressedSize;
+    return true;
+  }
+
+  bool compress(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst, atInt32 level) const override {
+    if (srcLen > (m_extended ? UINT_MAX / 2 : 0xFFFFFF))
+      return false;
+
+    LZ77Codec& codec = threadCodec();
+    codec.setMaxChainDepth(level <= minLevel() ? LZ77FastChainDepth : 0);
+    codec.setParseEffort(std::max(level - 1, 0));
+    atUint8* out = nullptr;
+    const atUint32 len = codec.compress(src, atUint32(srcLen), &out, m_extended);
+    dst.assign(out, out + len);
+    delete[] out;
+    return len != 0;
+  }
+
+  bool decompress(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst) const override {
+    atUint64 size;
+    if (!peekSize(src, srcLen, size) || size > atUint64(srcLen) * (m_extended ? LZ11MaxRatio : LZ10MaxRatio))
+      return false;
+    return threadCodec().decompress(src, srcLen, dst) == Status::Ok;
+  }
+
+  std::unique_ptr<IStreamReader> openReader(std::unique_ptr<IStreamReader>&& source) const override {
+    return std::make_unique<LZ77Reader>(std::move(source));
+  }
+
+private:
+  static LZ77Codec& threadCodec() {
+    thread_local LZ77Codec codec;
+    return codec;
+  }
+
+  bool m_extended;
+};
+
+#if AT_LZOKAY
+/* Raw LZO1X, as stored in game archives. There is no header, so detect never picks it and the
+ * output is grown until the data fits. */
+class LZOFormat : public Codec {
+public:
+  CodecType type() const override { return CodecType::LZO; }
+  std::string_view name() const override { return "lzo"; }
+  atInt32 minLevel() const override { return 0; }
+  atInt32 maxLevel() const override { return 0; }
+  atInt32 defaultLevel() const override { return 0; }
+
+  bool matches(const atUint8* /*src*/, size_t /*srcLen*/) const override { return false; }
+
+  bool peekSize(const atUint8* /*src*/, size_t /*srcLen*/, atUint64& /*size*/) const override { return false; }
+
+  bool compress(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst, atInt32 /*level*/) const override {
+    dst.resize(LZOCompressor::maxCompressedSize(srcLen));
+    size_t compressedLen;
+    if (compressLZO(src, srcLen, dst.data(), dst.size(), compressedLen) != Status::Ok)
+      return false;
+    dst.resize(compressedLen);
+    return true;
+  }
+
+  bool decompress(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst) const override {
+    const atUint64 maxSize = atUint64(srcLen) * LZOMaxRatio + 0x100;
+    dst.resize(size_t(std::clamp<atUint64>(atUint64(srcLen) * 4, 0x100, maxSize)));
+    for (;;) {
+      size_t decompressedLen;
+      const Status status = decompressLZO(src, srcLen, dst.data(), dst.size(), decompressedLen);
+      if (status == Status::Ok) {
+        dst.resize(decompressedLen);
+        return true;
+      }
+      if (status != Status::OutputOverrun || dst.size() >= maxSize)
+        return false;
+      dst.resize(size_t(std::min<atUint64>(atUint64(dst.size()) * 2, maxSize)));
+    }
+  }
+};
+#endif
+
+bool isLZ77(const Codec& codec) { return codec.type() == CodecType::LZ10 || codec.type() == CodecType::LZ11; }
+} // Anonymous namespace
+
+std::unique_ptr<IStreamReader> Codec::openReader(std::unique_ptr<IStreamReader>&& /*source*/) const {
+  return nullptr;
+}
+
+std::unique_ptr<IStreamWriter> Codec::openWriter(std::unique_ptr<IStreamWriter>&& /*destination*/,
+                                                 atInt32 /*level*/) const {
+  return nullptr;
+}
+
+CodecRegistry::CodecRegistry() {
+  m_codecs.push_back(std::make_unique<Yaz0Format>());
+  m_codecs.push_back(std::make_unique<ZlibFormat>(true));
+  m_codecs.push_back(std::make_unique<ZlibFormat>(false));
+  m_codecs.push_back(std::make_unique<LZ77Format>(false));
+  m_codecs.push_back(std::make_unique<LZ77Format>(true));
+#if AT_LZOKAY
+  m_codecs.push_back(std::make_unique<LZOFormat>());
+#endif
+}
+
+CodecRegistry& CodecRegistry::instance() {
+  static CodecRegistry registry;
+  return registry;
+}
+
+void CodecRegistry::add(std::unique_ptr<Codec>&& codec) {
+  if (codec)
+    m_codecs.push_back(std::move(codec));
+}
+
+const Codec* CodecRegistry::find(CodecType type) const {
+  for (const auto& codec : m_codecs)
+    if (codec->type() == type)
+      return codec.get();
+  return nullptr;
+}
+
+const Codec* CodecRegistry::find(std::string_view name) const {
+  for (const auto& codec : m_codecs)
+    if (codec->name() == name)
+      return codec.get();
+  return nullptr;
+}
+
+const Codec* CodecRegistry::detect(const atUint8* src, size_t srcLen) const {
+  if (!src)
+    return nullptr;
+
+  for (const auto& codec : m_codecs)
+    if (!isLZ77(*codec) && codec->matches(src, srcLen))
+      return codec.get();
+  for (const auto& codec : m_codecs)
+    if (isLZ77(*codec) && codec->matches(src, srcLen))
+      return codec.get();
+  return nullptr;
+}
+
+bool autoDecompress(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst) {
+  const Codec* codec = detect(src, srcLen);
+  return codec && codec->decompress(src, srcLen, dst);
+}
+
+AutoCompressResult autoCompress(const atUint8* src, size_t srcLen, std::chrono::milliseconds budget,
+                                atUint32 threads) {
+  using Clock = std::chrono::steady_clock;
+  struct Candidate {
+    const Codec* codec;
+    Clock::duration estimate;
+    std::vector<atUint8> data;
+    bool ok;
+  };
+
+  const auto start = Clock::now();
+  const auto& codecs = CodecRegistry::instance().codecs();
+  const size_t sampleLen = std::min(srcLen, SampleSize);
+  const bool sampleIsAll = sampleLen == srcLen;
+
+  // Time every codec on the sample and scale up to the whole input
+  std::vector<Candidate> candidates;
+  candidates.reserve(codecs.size());
+  for (const auto& codec : codecs) {
+    Candidate candidate{codec.get(), {}, {}, false};
+    const auto sampleStart = Clock::now();
+    candidate.ok = codec->compress(src, sampleLen, candidate.data, codec->defaultLevel());
+    const auto elapsed = Clock::now() - sampleStart;
+    candidate.estimate = sampleLen ? elapsed * atInt64(srcLen / sampleLen) : elapsed;
+    if (candidate.ok)
+      candidates.push_back(std::move(candidate));
+  }
+
+  AutoCompressResult result;
+  if (candidates.empty())
+    return result;
+
+  if (!sampleIsAll) {
+    const auto remaining = budget - (Clock::now() - start);
+    const auto fastest = std::min_element(candidates.begin(), candidates.end(),
+                                          [](const Candidate& a, const Candidate& b) { return a.estimate < b.estimate; });
+    std::swap(*fastest, candidates.front());
+    candidates.erase(std::remove_if(candidates.begin() + 1, candidates.end(),
+                                    [&](const Candidate& c) { return c.estimate > remaining; }),
+                     candidates.end());
+
+    parallelFor(candidates.size(), threads, [&](atUint32 /*worker*/, size_t i) {
+      Candidate& candidate = candidates[i];
+      candidate.ok = candidate.codec->compress(src, srcLen, candidate.data, candidate.codec->defaultLevel());
+    });
+  }
+
+  for (Candidate& candidate : candidates) {
+    if (candidate.ok && (!result.codec || candidate.data.size() < result.data.size())) {
+      result.codec = candidate.codec;
+      result.data = std::move(candidate.data);
+    }
+  }
+  return result;
+}
+} // namespace athena::io::Compression
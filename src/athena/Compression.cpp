@@ -1,309 +1,803 @@
 #include "athena/Compression.hpp"
+#include "athena/ParallelFor.hpp"
+#include "athena/Utility.hpp"
 
 #if AT_LZOKAY
 #include <lzokay.hpp>
 #endif
 
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
 #include <zlib.h>
-#include "LZ77/LZType10.hpp"
-#include "LZ77/LZType11.hpp"
 
 namespace athena::io::Compression {
+namespace {
+constexpr uInt clampAvail(size_t len) { return uInt(std::min<size_t>(len, UINT_MAX)); }
+
+Status zlibStatus(atInt32 err) {
+  switch (err) {
+  case Z_OK:
+  case Z_STREAM_END:
+    return Status::Ok;
+  case Z_BUF_ERROR:
+    return Status::OutputOverrun;
+  case Z_NEED_DICT:
+  case Z_DATA_ERROR:
+    return Status::InvalidData;
+  case Z_STREAM_ERROR:
+    return Status::InvalidArgument;
+  default:
+    return Status::Error;
+  }
+}
 
-atInt32 decompressZlib(const atUint8* src, atUint32 srcLen, atUint8* dst, atUint32 dstLen) {
-  z_stream strm = {};
-  strm.avail_in = srcLen;
-  strm.avail_out = dstLen;
+// The atInt32 entry points report failures as zlib error codes
+atInt32 zlibError(Status status) {
+  switch (status) {
+  case Status::Ok:
+    return Z_OK;
+  case Status::TruncatedInput:
+  case Status::OutputOverrun:
+    return Z_BUF_ERROR;
+  case Status::InvalidData:
+    return Z_DATA_ERROR;
+  case Status::InvalidArgument:
+    return Z_STREAM_ERROR;
+  default:
+    return Z_MEM_ERROR;
+  }
+}
+
+ZlibCompressor& threadZlibCompressor() {
+  thread_local ZlibCompressor compressor;
+  return compressor;
+}
+
+ZlibDecompressor& threadZlibDecompressor() {
+  thread_local ZlibDecompressor decompressor;
+  return decompressor;
+}
+} // Anonymous namespace
+
+ZlibCompressor::ZlibCompressor(atInt32 level, atInt32 windowBits)
+: m_stream(std::make_unique<z_stream_s>()), m_level(level), m_windowBits(windowBits) {
+  m_initResult = deflateInit2(m_stream.get(), m_level, Z_DEFLATED, m_windowBits, 8, Z_DEFAULT_STRATEGY);
+}
+
+ZlibCompressor::~ZlibCompressor() {
+  if (m_initResult == Z_OK)
+    deflateEnd(m_stream.get());
+}
+
+void ZlibCompressor::setLevel(atInt32 level) {
+  if (level == m_level)
+    return;
+  m_level = level;
+  // deflateParams may flush through the previous call's output buffer on some zlib versions, start over instead
+  if (m_initResult == Z_OK)
+    deflateEnd(m_stream.get());
+  *m_stream = {};
+  m_initResult = deflateInit2(m_stream.get(), m_level, Z_DEFLATED, m_windowBits, 8, Z_DEFAULT_STRATEGY);
+}
+
+Status ZlibCompressor::compress(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen,
+                                size_t& compressedLen) {
+  compressedLen = 0;
+  if (m_initResult != Z_OK)
+    return zlibStatus(m_initResult);
+
+  z_stream& strm = *m_stream;
+  atInt32 err = deflateReset(&strm);
+  if (err != Z_OK)
+    return zlibStatus(err);
+
+  // zlib counts in uInt, larger buffers are fed through in pieces
   strm.next_in = const_cast<Bytef*>(src);
   strm.next_out = dst;
-  strm.zalloc = Z_NULL;
-  strm.zfree = Z_NULL;
-  strm.opaque = Z_NULL;
-
-  atInt32 ret;
-  // 15 window bits, and the | 16 tells zlib to to detect if using gzip or zlib
-  ret = inflateInit2(&strm, MAX_WBITS | 16);
-
-  if (ret == Z_OK) {
-    ret = inflate(&strm, Z_FINISH);
-    if (ret == Z_STREAM_END) {
-      ret = strm.total_out;
-    }
+  size_t inLeft = srcLen;
+  size_t outLeft = dstLen;
+  for (;;) {
+    strm.avail_in = clampAvail(inLeft);
+    strm.avail_out = clampAvail(outLeft);
+    const uInt availIn = strm.avail_in;
+    const uInt availOut = strm.avail_out;
+    err = deflate(&strm, inLeft == availIn ? Z_FINISH : Z_NO_FLUSH);
+    inLeft -= availIn - strm.avail_in;
+    outLeft -= availOut - strm.avail_out;
+
+    if (err == Z_STREAM_END)
+      break;
+    if (err != Z_OK && err != Z_BUF_ERROR)
+      return zlibStatus(err);
+    if (outLeft == 0 || (err == Z_BUF_ERROR && strm.avail_out != 0))
+      return Status::OutputOverrun;
   }
-  inflateEnd(&strm);
-  return ret;
+
+  compressedLen = dstLen - outLeft;
+  return Status::Ok;
+}
+
+atInt32 ZlibCompressor::compress(const atUint8* src, atUint32 srcLen, atUint8* dst, atUint32 dstLen) {
+  if (m_initResult != Z_OK)
+    return m_initResult;
+
+  size_t compressedLen;
+  const Status status = compress(src, size_t(srcLen), dst, size_t(dstLen), compressedLen);
+  return status == Status::Ok ? atInt32(compressedLen) : zlibError(status);
+}
+
+ZlibDecompressor::ZlibDecompressor() : m_stream(std::make_unique<z_stream_s>()) {
+  // 15 window bits, and the | 32 tells zlib to to detect if using gzip or zlib
+  m_initResult = inflateInit2(m_stream.get(), MAX_WBITS | 32);
+}
+
+ZlibDecompressor::~ZlibDecompressor() {
+  if (m_initResult == Z_OK)
+    inflateEnd(m_stream.get());
+}
+
+Status ZlibDecompressor::decompress(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen,
+                                    size_t& decompressedLen) {
+  decompressedLen = 0;
+  if (m_initResult != Z_OK)
+    return zlibStatus(m_initResult);
+
+  z_stream& strm = *m_stream;
+  atInt32 ret = inflateReset(&strm);
+  if (ret != Z_OK)
+    return zlibStatus(ret);
+
+  strm.next_in = const_cast<Bytef*>(src);
+  strm.next_out = dst;
+  size_t inLeft = srcLen;
+  size_t outLeft = dstLen;
+  for (;;) {
+    strm.avail_in = clampAvail(inLeft);
+    strm.avail_out = clampAvail(outLeft);
+    const uInt availIn = strm.avail_in;
+    const uInt availOut = strm.avail_out;
+    ret = inflate(&strm, Z_NO_FLUSH);
+    inLeft -= availIn - strm.avail_in;
+    outLeft -= availOut - strm.avail_out;
+
+    if (ret == Z_STREAM_END)
+      break;
+    if (ret != Z_OK && ret != Z_BUF_ERROR)
+      return zlibStatus(ret);
+    // No progress means one side ran dry
+    if (ret == Z_BUF_ERROR)
+      return inLeft == 0 ? Status::TruncatedInput : Status::OutputOverrun;
+  }
+
+  decompressedLen = dstLen - outLeft;
+  return Status::Ok;
+}
+
+atInt32 ZlibDecompressor::decompress(const atUint8* src, atUint32 srcLen, atUint8* dst, atUint32 dstLen) {
+  if (m_initResult != Z_OK)
+    return m_initResult;
+
+  size_t decompressedLen;
+  const Status status = decompress(src, size_t(srcLen), dst, size_t(dstLen), decompressedLen);
+  return status == Status::Ok ? atInt32(decompressedLen) : zlibError(status);
+}
+
+atInt32 decompressZlib(const atUint8* src, atUint32 srcLen, atUint8* dst, atUint32 dstLen) {
+  return threadZlibDecompressor().decompress(src, srcLen, dst, dstLen);
+}
+
+atInt32 compressZlib(const atUint8* src, atUint32 srcLen, atUint8* dst, atUint32 dstLen, atInt32 level) {
+  ZlibCompressor& compressor = threadZlibCompressor();
+  compressor.setLevel(level);
+  return compressor.compress(src, srcLen, dst, dstLen);
+}
+
+Status decompressZlib(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& decompressedLen) {
+  return threadZlibDecompressor().decompress(src, srcLen, dst, dstLen, decompressedLen);
+}
+
+Status compressZlib(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& compressedLen,
+                    atInt32 level) {
+  ZlibCompressor& compressor = threadZlibCompressor();
+  compressor.setLevel(level);
+  return compressor.compress(src, srcLen, dst, dstLen, compressedLen);
 }
 
-atInt32 compressZlib(const atUint8* src, atUint32 srcLen, atUint8* dst, atUint32 dstLen) {
+namespace {
+constexpr atUint64 ParallelBlockSize = 0x40000;
+constexpr atUint32 ParallelDictSize = 0x8000;
+
+struct ParallelBlock {
+  std::vector<atUint8> data;
+  atUint32 check = 0; // adler32 or crc32 of the block's input
+  bool ok = false;
+};
+
+// Each thread keeps one deflate state for all the blocks it takes
+struct DeflateWorker {
   z_stream strm = {};
-  strm.total_in = strm.avail_in = srcLen;
-  strm.total_out = strm.avail_out = dstLen;
-  strm.next_in = (Bytef*)src;
-  strm.next_out = (Bytef*)dst;
+  bool ready = false;
+};
+
+// Deflates a block into raw deflate data ending on a byte boundary, so the blocks can simply be concatenated
+void deflateBlock(DeflateWorker& worker, const atUint8* src, atUint64 srcLen, atInt32 level, bool gzip,
+                  std::vector<ParallelBlock>& blocks, size_t i) {
+  z_stream& strm = worker.strm;
+  if (!worker.ready) {
+    if (deflateInit2(&strm, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+      return;
+    worker.ready = true;
+  }
 
-  strm.zalloc = Z_NULL;
-  strm.zfree = Z_NULL;
-  strm.opaque = Z_NULL;
+  ParallelBlock& block = blocks[i];
+  const atUint64 begin = i * ParallelBlockSize;
+  const uInt len = uInt(std::min(ParallelBlockSize, srcLen - begin));
+  const bool last = i == blocks.size() - 1;
+
+  if (deflateReset(&strm) != Z_OK)
+    return;
+  if (begin) {
+    const uInt dictSize = uInt(std::min<atUint64>(ParallelDictSize, begin));
+    if (deflateSetDictionary(&strm, src + begin - dictSize, dictSize) != Z_OK)
+      return;
+  }
 
-  atInt32 err = -1;
-  atInt32 ret = -1;
+  // Room for the sync flush's empty stored block on top of the worst case
+  block.data.resize(deflateBound(&strm, len) + 16);
+  strm.next_in = const_cast<Bytef*>(src + begin);
+  strm.avail_in = len;
+  strm.next_out = block.data.data();
+  strm.avail_out = uInt(block.data.size());
 
-  err = deflateInit(&strm, Z_BEST_COMPRESSION);
+  const atInt32 err = deflate(&strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+  if (err != (last ? Z_STREAM_END : Z_OK) || strm.avail_in != 0)
+    return;
 
-  if (err == Z_OK) {
-    err = deflate(&strm, Z_FINISH);
+  block.data.resize(block.data.size() - strm.avail_out);
+  block.check = gzip ? crc32(0, src + begin, len) : adler32(1, src + begin, len);
+  block.ok = true;
+}
+} // Anonymous namespace
+
+atUint64 compressZlibParallel(const atUint8* src, atUint64 srcLen, atUint8** dst, atInt32 level, atUint32 threads,
+                              bool gzip) {
+  *dst = nullptr;
+  if (!src && srcLen)
+    return 0;
+
+  std::vector<ParallelBlock> blocks(std::max<atUint64>((srcLen + ParallelBlockSize - 1) / ParallelBlockSize, 1));
+  std::vector<DeflateWorker> workers(parallelThreads(blocks.size(), threads));
+  parallelFor(blocks.size(), threads, [&](atUint32 worker, size_t i) {
+    deflateBlock(workers[worker], src, srcLen, level, gzip, blocks, i);
+  });
+  for (DeflateWorker& worker : workers)
+    if (worker.ready)
+      deflateEnd(&worker.strm);
+
+  atUint64 compressedLen = 0;
+  atUint32 check = gzip ? crc32(0, nullptr, 0) : adler32(0, nullptr, 0);
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    if (!blocks[i].ok)
+      return 0;
+    const z_off_t len = z_off_t(std::min(ParallelBlockSize, srcLen - i * ParallelBlockSize));
+    check = gzip ? crc32_combine(check, blocks[i].check, len) : adler32_combine(check, blocks[i].check, len);
+    compressedLen += blocks[i].data.size();
+  }
 
-    if (err == Z_STREAM_END)
-      ret = strm.total_out;
-    else {
-      deflateEnd(&strm);
-      return err;
-    }
+  atUint8 header[10];
+  atUint32 headerLen;
+  if (gzip) {
+    // No name or time stamp; extra flags as deflate sets them, unknown OS
+    const atUint8 extraFlags = level == Z_BEST_COMPRESSION ? 2 : level == Z_BEST_SPEED ? 4 : 0;
+    const atUint8 gzipHeader[10] = {0x1F, 0x8B, Z_DEFLATED, 0, 0, 0, 0, 0, extraFlags, 0xFF};
+    memcpy(header, gzipHeader, sizeof(gzipHeader));
+    headerLen = 10;
   } else {
-    deflateEnd(&strm);
-    return err;
+    // 32 KiB window, deflate, and the level hint zlib itself would write
+    const atInt32 effectiveLevel = level == Z_DEFAULT_COMPRESSION ? 6 : level;
+    const atUint32 levelFlags = effectiveLevel < 2 ? 0 : effectiveLevel < 6 ? 1 : effectiveLevel == 6 ? 2 : 3;
+    atUint32 cmf = (0x78 << 8) | (levelFlags << 6);
+    cmf += 31 - cmf % 31;
+    header[0] = atUint8(cmf >> 8);
+    header[1] = atUint8(cmf);
+    headerLen = 2;
   }
 
-  deflateEnd(&strm);
+  const atUint32 trailerLen = gzip ? 8 : 4;
+  atUint8* out = new atUint8[headerLen + compressedLen + trailerLen];
+  *dst = out;
+  memcpy(out, header, headerLen);
+  out += headerLen;
+  for (const ParallelBlock& block : blocks) {
+    memcpy(out, block.data.data(), block.data.size());
+    out += block.data.size();
+  }
 
-  return ret;
+  if (gzip) {
+    // Both little endian, the size modulo 2^32
+    const atUint32 size = atUint32(srcLen);
+    for (atUint32 i = 0; i < 4; ++i) {
+      out[i] = atUint8(check >> (i * 8));
+      out[i + 4] = atUint8(size >> (i * 8));
+    }
+  } else {
+    for (atUint32 i = 0; i < 4; ++i)
+      out[i] = atUint8(check >> (24 - i * 8));
+  }
+
+  return headerLen + compressedLen + trailerLen;
 }
 
 #if AT_LZOKAY
+namespace {
+Status lzoStatus(lzokay::EResult result) {
+  switch (result) {
+  case lzokay::EResult::Success:
+    return Status::Ok;
+  case lzokay::EResult::InputOverrun:
+    return Status::TruncatedInput;
+  case lzokay::EResult::OutputOverrun:
+    return Status::OutputOverrun;
+  case lzokay::EResult::LookbehindOverrun:
+  case lzokay::EResult::InputNotConsumed:
+    return Status::InvalidData;
+  default:
+    return Status::Error;
+  }
+}
+} // Anonymous namespace
+
 atInt32 decompressLZO(const atUint8* source, const atInt32 sourceSize, atUint8* dst, atInt32& dstSize) {
-  size_t size = dstSize;
-  auto result = lzokay::decompress(source, sourceSize, dst, size);
+  size_t size = 0;
+  auto result = lzokay::decompress(source, sourceSize, dst, dstSize, size);
   dstSize -= (atInt32)size;
 
   return (atInt32)result;
 }
+
+struct LZOCompressor::Dictionary {
+  lzokay::Dict<> dict;
+};
+
+LZOCompressor::LZOCompressor() : m_dict(std::make_unique<Dictionary>()) {}
+#else
+struct LZOCompressor::Dictionary {};
+
+LZOCompressor::LZOCompressor() = default;
 #endif
 
-// src points to the yaz0 source data (to the "real" source data, not at the header!)
-// dst points to a buffer uncompressedSize bytes large (you get uncompressedSize from
-// the second 4 bytes in the Yaz0 header).
-atUint32 yaz0Decode(const atUint8* src, atUint8* dst, atUint32 uncompressedSize) {
-  atUint32 srcPlace = 0, dstPlace = 0; // current read/write positions
+LZOCompressor::~LZOCompressor() = default;
 
-  atInt32 validBitCount = 0; // number of valid bits left in "code" byte
-  atUint8 currCodeByte;
+Status LZOCompressor::compress(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& compressedLen) {
+  compressedLen = 0;
+#if AT_LZOKAY
+  return lzoStatus(lzokay::compress(src, srcLen, dst, dstLen, compressedLen, m_dict->dict));
+#else
+  (void)src, (void)srcLen, (void)dst, (void)dstLen;
+  return Status::Unsupported;
+#endif
+}
 
-  while (dstPlace < uncompressedSize) {
-    // read new "code" byte if the current one is used up
-    if (validBitCount == 0) {
-      currCodeByte = src[srcPlace];
-      ++srcPlace;
-      validBitCount = 8;
-    }
+Status compressLZO(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& compressedLen) {
+#if AT_LZOKAY
+  thread_local LZOCompressor compressor;
+  return compressor.compress(src, srcLen, dst, dstLen, compressedLen);
+#else
+  (void)src, (void)srcLen, (void)dst, (void)dstLen;
+  compressedLen = 0;
+  return Status::Unsupported;
+#endif
+}
 
-    if ((currCodeByte & 0x80) != 0) {
-      // straight copy
-      dst[dstPlace] = src[srcPlace];
-      dstPlace++;
-      srcPlace++;
-    } else {
-      // RLE part
-      atUint8 byte1 = src[srcPlace];
-      atUint8 byte2 = src[srcPlace + 1];
-      srcPlace += 2;
+Status decompressLZO(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& decompressedLen) {
+  decompressedLen = 0;
+#if AT_LZOKAY
+  return lzoStatus(lzokay::decompress(src, srcLen, dst, dstLen, decompressedLen));
+#else
+  (void)src, (void)srcLen, (void)dst, (void)dstLen;
+  return Status::Unsupported;
+#endif
+}
 
-      atUint32 dist = ((byte1 & 0xF) << 8) | byte2;
-      atUint32 copySource = dstPlace - (dist + 1);
+namespace {
+// Shared by both decoders, only the bounds-checked one knows where src ends
+template <bool CheckSrc>
+Status yaz0DecodeImpl(const atUint8* src, const atUint8* srcEnd, atUint8* dst, atUint32 dstLen,
+                      atUint32& decodedLen) {
+  atUint8* out = dst;
+  atUint8* const outEnd = dst + dstLen;
+  Status status = Status::Ok;
+
+  while (out < outEnd) {
+    if (CheckSrc && src >= srcEnd) {
+      status = Status::TruncatedInput;
+      break;
+    }
+    atUint8 currCodeByte = *src++;
+
+    // Eight straight copies in a row are common in poorly compressible data
+    if (currCodeByte == 0xFF && outEnd - out >= 8 && (!CheckSrc || srcEnd - src >= 8)) {
+      memcpy(out, src, 8);
+      out += 8;
+      src += 8;
+      continue;
+    }
 
-      atUint32 numBytes = byte1 >> 4;
+    for (atInt32 validBitCount = 8; validBitCount > 0 && out < outEnd; --validBitCount, currCodeByte <<= 1) {
+      if ((currCodeByte & 0x80) != 0) {
+        // straight copy
+        if (CheckSrc && src >= srcEnd) {
+          status = Status::TruncatedInput;
+          break;
+        }
+        *out++ = *src++;
+        continue;
+      }
 
+      // RLE part
+      if (CheckSrc && srcEnd - src < 2) {
+        status = Status::TruncatedInput;
+        break;
+      }
+      const atUint8 byte1 = src[0];
+      const atUint8 byte2 = src[1];
+      src += 2;
+
+      const size_t dist = (((byte1 & 0xF) << 8) | byte2) + 1;
+      size_t numBytes = byte1 >> 4;
       if (numBytes == 0) {
-        numBytes = src[srcPlace] + 0x12;
-        srcPlace++;
-      } else
+        if (CheckSrc && src >= srcEnd) {
+          status = Status::TruncatedInput;
+          break;
+        }
+        numBytes = *src++ + 0x12;
+      } else {
         numBytes += 2;
+      }
+
+      if (dist > size_t(out - dst)) {
+        status = Status::InvalidData;
+        break;
+      }
+      if (numBytes > size_t(outEnd - out)) {
+        status = Status::OutputOverrun;
+        break;
+      }
 
       // copy run
-      for (atUint32 i = 0; i < numBytes; ++i) {
-        dst[dstPlace] = dst[copySource];
-        copySource++;
-        dstPlace++;
+      const atUint8* copySource = out - dist;
+      atUint8* const runEnd = out + numBytes;
+      if (dist == 1) {
+        // A single repeated byte
+        memset(out, *copySource, numBytes);
+        out = runEnd;
+      } else if (dist >= 8 && size_t(outEnd - runEnd) >= 15) {
+        // Chunks never reach bytes they write themselves, overshooting the run is fine with room behind it
+        if (dist >= 16) {
+          for (; out < runEnd; out += 16, copySource += 16)
+            memcpy(out, copySource, 16);
+        } else {
+          for (; out < runEnd; out += 8, copySource += 8)
+            memcpy(out, copySource, 8);
+        }
+        out = runEnd;
+      } else {
+        while (out < runEnd)
+          *out++ = *copySource++;
       }
     }
 
-    // use next bit from "code" byte
-    currCodeByte <<= 1;
-    validBitCount -= 1;
+    if (status != Status::Ok)
+      break;
   }
 
-  return dstPlace;
+  decodedLen = atUint32(out - dst);
+  return status;
+}
+} // Anonymous namespace
+
+Status yaz0PeekHeader(const atUint8* src, size_t srcLen, atUint64& uncompressedSize) {
+  if (srcLen < Yaz0HeaderSize)
+    return Status::TruncatedInput;
+  if (memcmp(src, "Yaz0", 4) != 0)
+    return Status::InvalidData;
+
+  atUint32 size;
+  memcpy(&size, src + 4, 4);
+  uncompressedSize = utility::BigUint32(size);
+  return Status::Ok;
 }
 
-// Yaz0 encode
-typedef struct {
-  atUint32 srcPos, dstPos;
-} yaz0_Ret;
+Status yaz0Decode(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& decodedLen) {
+  decodedLen = 0;
+  // The header stores the size in 32 bits
+  if (dstLen > UINT32_MAX)
+    return Status::InvalidArgument;
 
-atUint32 simpleEnc(const atUint8* src, atInt32 size, atInt32 pos, atUint32* pMatchPos);
-atUint32 nintendoEnc(const atUint8* src, atInt32 size, atInt32 pos, atUint32* pMatchPos);
+  atUint32 written = 0;
+  const Status status = yaz0DecodeImpl<true>(src, src + srcLen, dst, atUint32(dstLen), written);
+  decodedLen = written;
+  return status;
+}
 
-atUint32 yaz0Encode(const atUint8* src, atUint32 srcSize, atUint8* data) {
-  yaz0_Ret r = {0, 0};
-  atInt32 pos = 0;
-  atUint8 dst[24]; // 8 codes * 3 bytes maximum
-  atUint32 dstSize = 0;
-  atUint32 i;
-
-  atUint32 validBitCount = 0; // number of valid bits left in "code" byte
-  atUint8 currCodeByte = 0;
-
-  while (r.srcPos < srcSize) {
-    atUint32 numBytes;
-    atUint32 matchPos;
-    numBytes = nintendoEnc(src, srcSize, r.srcPos, &matchPos);
-
-    if (numBytes < 3) {
-      // straight copy
-      dst[r.dstPos] = src[r.srcPos];
-      r.dstPos++;
-      r.srcPos++;
-      // set flag for straight copy
-      currCodeByte |= (0x80 >> validBitCount);
-    } else {
-      // RLE part
-      atUint32 dist = r.srcPos - matchPos - 1;
-      atUint8 byte1, byte2, byte3;
-
-      if (numBytes >= 0x12) // 3 byte encoding
-      {
-        byte1 = 0 | (dist >> 8);
-        byte2 = dist & 0xff;
-        dst[r.dstPos++] = byte1;
-        dst[r.dstPos++] = byte2;
-
-        // maximum runlength for 3 byte encoding
-        if (numBytes > 0xff + 0x12)
-          numBytes = 0xff + 0x12;
-
-        byte3 = numBytes - 0x12;
-        dst[r.dstPos++] = byte3;
-      } else // 2 byte encoding
-      {
-        byte1 = ((numBytes - 2) << 4) | (dist >> 8);
-        byte2 = dist & 0xff;
-        dst[r.dstPos++] = byte1;
-        dst[r.dstPos++] = byte2;
-      }
+// src points to the yaz0 source data (to the "real" source data, not at the header!)
+// dst points to a buffer uncompressedSize bytes large (you get uncompressedSize from
+// the second 4 bytes in the Yaz0 header).
+atUint32 yaz0Decode(const atUint8* src, atUint8* dst, atUint32 uncompressedSize) {
+  atUint32 written = 0;
+  yaz0DecodeImpl<false>(src, nullptr, dst, uncompressedSize, written);
+  return written;
+}
+
+namespace {
+// Yaz0 matches reach back 0x1000 bytes and run up to 0xFF + 0x12 bytes
+constexpr atInt32 Yaz0Window = 0x1000;
+constexpr atInt32 Yaz0MaxMatch = 0xFF + 0x12;
+constexpr atInt32 Yaz0FastChainDepth = 16;
+
+// Token costs in bits, each token also takes one bit of a code byte
+constexpr atUint32 Yaz0LiteralCost = 9;
+constexpr atUint32 Yaz0ShortMatchCost = 17;
+constexpr atUint32 Yaz0LongMatchCost = 25;
+
+// Packs tokens behind a code byte that is only emitted once its first token is
+class Yaz0TokenWriter {
+public:
+  explicit Yaz0TokenWriter(atUint8* dst) : m_begin(dst), m_out(dst) {}
+
+  void literal(atUint8 val) {
+    atUint8& code = nextCode();
+    code |= 0x80 >> m_bit;
+    *m_out++ = val;
+    advance();
+  }
 
-      r.srcPos += numBytes;
+  void match(atUint32 dist, atUint32 numBytes) {
+    nextCode();
+    if (numBytes >= 0x12) { // 3 byte encoding
+      *m_out++ = atUint8(dist >> 8);
+      *m_out++ = atUint8(dist & 0xFF);
+      *m_out++ = atUint8(numBytes - 0x12);
+    } else { // 2 byte encoding
+      *m_out++ = atUint8(((numBytes - 2) << 4) | (dist >> 8));
+      *m_out++ = atUint8(dist & 0xFF);
     }
+    advance();
+  }
 
-    validBitCount++;
+  atUint32 size() const { return atUint32(m_out - m_begin); }
 
-    // write eight codes
-    if (validBitCount == 8) {
-      data[pos] = currCodeByte;
-      pos++;
+private:
+  atUint8& nextCode() {
+    if (m_bit == 0) {
+      m_code = m_out++;
+      *m_code = 0;
+    }
+    return *m_code;
+  }
 
-      for (i = 0; i < /*=*/r.dstPos; pos++, i++)
-        data[pos] = dst[i];
+  void advance() { m_bit = (m_bit + 1) & 7; }
 
-      dstSize += r.dstPos + 1;
+  atUint8* m_begin;
+  atUint8* m_out;
+  atUint8* m_code = nullptr;
+  atUint32 m_bit = 0;
+};
 
-      currCodeByte = 0;
-      validBitCount = 0;
-      r.dstPos = 0;
-    }
-  }
+// Matches shorter than three bytes cost more than the literals they replace
+LZLengthOffset yaz0Search(LZLookupTable& table, const atUint8* pos, const atUint8* src, const atUint8* srcEnd) {
+  LZLengthOffset ret = table.search(pos, src, srcEnd);
+  if (ret.length < 3)
+    ret = {0, 0};
+  return ret;
+}
+} // Anonymous namespace
 
-  if (validBitCount > 0) {
-    data[pos] = currCodeByte;
-    pos++;
+namespace {
+Yaz0Encoder& threadYaz0Encoder() {
+  thread_local Yaz0Encoder encoder;
+  return encoder;
+}
+} // Anonymous namespace
 
-    for (i = 0; i < /*=*/r.dstPos; pos++, i++)
-      data[pos] = dst[i];
+atUint32 yaz0Encode(const atUint8* src, atUint32 srcSize, atUint8* data) {
+  return threadYaz0Encoder().encode(src, srcSize, data);
+}
 
-    dstSize += r.dstPos + 1;
+Status yaz0Encode(const atUint8* src, size_t srcSize, atUint8* dst, size_t dstLen, size_t& encodedLen) {
+  return threadYaz0Encoder().encode(src, srcSize, dst, dstLen, encodedLen);
+}
 
-    currCodeByte = 0;
-    validBitCount = 0;
-    r.dstPos = 0;
-  }
+Yaz0Encoder::Yaz0Encoder(Level level) : m_table(3, Yaz0Window, Yaz0MaxMatch) { setLevel(level); }
 
-  return dstSize;
+void Yaz0Encoder::setLevel(Level level) {
+  m_level = level;
+  m_table.setMaxChainDepth(level == Level::Fast ? Yaz0FastChainDepth : 0);
 }
 
-// a lookahead encoding scheme for ngc Yaz0
-atUint32 nintendoEnc(const atUint8* src, atInt32 size, atInt32 pos, atUint32* pMatchPos) {
-  atUint32 numBytes = 1;
-  static atUint32 numBytes1;
-  static atUint32 matchPos;
-  static atInt32 prevFlag = 0;
+Status Yaz0Encoder::encode(const atUint8* src, size_t srcSize, atUint8* dst, size_t dstLen, size_t& encodedLen) {
+  encodedLen = 0;
+  // The header stores the size in 32 bits, and so must the worst case output
+  if (srcSize > atUint64(UINT32_MAX) * 8 / 9)
+    return Status::InvalidArgument;
+  if (dstLen < maxEncodedSize(atUint32(srcSize)))
+    return Status::OutputOverrun;
 
-  // if prevFlag is set, it means that the previous position was determined by look-ahead try.
-  // so just use it. this is not the best optimization, but nintendo's choice for speed.
-  if (prevFlag == 1) {
-    *pMatchPos = matchPos;
-    prevFlag = 0;
-    return numBytes1;
-  }
+  encodedLen = encode(src, atUint32(srcSize), dst);
+  return Status::Ok;
+}
 
-  prevFlag = 0;
-  numBytes = simpleEnc(src, size, pos, &matchPos);
-  *pMatchPos = matchPos;
+atUint32 Yaz0Encoder::encode(const atUint8* src, atUint32 srcSize, atUint8* dst) {
+  Yaz0TokenWriter out(dst);
+  const atUint8* srcEnd = src + srcSize;
+  m_table.reset();
+
+  if (m_level == Level::Optimal) {
+    parseOptimal(src, srcSize);
+    for (atUint32 pos = 0; pos < srcSize; pos += m_matchLength[pos]) {
+      if (m_matchLength[pos] == 1)
+        out.literal(src[pos]);
+      else
+        out.match(m_matchOffset[pos] - 1, m_matchLength[pos]);
+    }
+    return out.size();
+  }
 
-  // if this position is RLE encoded, then compare to copying 1 byte and next position(pos+1) encoding
-  if (numBytes >= 3) {
-    numBytes1 = simpleEnc(src, size, pos + 1, &matchPos);
+  atUint32 pos = 0;
+  while (pos < srcSize) {
+    LZLengthOffset cur = yaz0Search(m_table, src + pos, src, srcEnd);
+
+    // If the next position encodes +2 longer, copy this byte and take that match instead.
+    // This does not guarantee the best result, but it is Nintendo's choice for speed.
+    if (m_level == Level::Nintendo && cur.length && pos + 1 < srcSize) {
+      LZLengthOffset next = yaz0Search(m_table, src + pos + 1, src, srcEnd);
+      if (next.length >= cur.length + 2) {
+        out.literal(src[pos++]);
+        cur = next;
+      }
+    }
 
-    // if the next position encoding is +2 longer than current position, choose it.
-    // this does not guarantee the best optimization, but fairly good optimization with speed.
-    if (numBytes1 >= numBytes + 2) {
-      numBytes = 1;
-      prevFlag = 1;
+    if (cur.length) {
+      out.match(cur.offset - 1, cur.length);
+      pos += cur.length;
+    } else {
+      out.literal(src[pos++]);
     }
   }
 
-  return numBytes;
+  return out.size();
 }
 
-// simple and straight encoding scheme for Yaz0
-atUint32 simpleEnc(const atUint8* src, atInt32 size, atInt32 pos, atUint32* pMatchPos) {
-  int startPos = pos - 0x1000, j, i;
-  atUint32 numBytes = 1;
-  atUint32 matchPos = 0;
+void Yaz0Encoder::parseOptimal(const atUint8* src, atUint32 srcSize) {
+  const atUint8* srcEnd = src + srcSize;
+  m_matchLength.resize(srcSize);
+  m_matchOffset.resize(srcSize);
+  m_cost.resize(srcSize + 1);
 
-  if (startPos < 0)
-    startPos = 0;
+  for (atUint32 pos = 0; pos < srcSize; ++pos) {
+    const LZLengthOffset found = yaz0Search(m_table, src + pos, src, srcEnd);
+    m_matchLength[pos] = atUint16(found.length);
+    m_matchOffset[pos] = found.offset;
+  }
 
-  for (i = startPos; i < pos; i++) {
-    for (j = 0; j < size - pos; j++) {
-      if (src[i + j] != src[j + pos])
-        break;
+  // Walk backwards keeping the cheapest way to encode each suffix. Every short length is
+  // tried since they all cost the same; of the long lengths only the longest is.
+  m_cost[srcSize] = 0;
+  for (atUint32 pos = srcSize; pos-- > 0;) {
+    const atUint32 longest = m_matchLength[pos];
+    atUint32 bestCost = Yaz0LiteralCost + m_cost[pos + 1];
+    atUint32 bestLength = 1;
+
+    for (atUint32 len = 3; len <= std::min<atUint32>(longest, 0x11); ++len) {
+      const atUint32 cost = Yaz0ShortMatchCost + m_cost[pos + len];
+      if (cost < bestCost) {
+        bestCost = cost;
+        bestLength = len;
+      }
     }
-
-    if ((atUint32)j > numBytes) {
-      numBytes = j;
-      matchPos = i;
+    if (longest >= 0x12 && Yaz0LongMatchCost + m_cost[pos + longest] < bestCost) {
+      bestCost = Yaz0LongMatchCost + m_cost[pos + longest];
+      bestLength = longest;
     }
+
+    m_cost[pos] = bestCost;
+    m_matchLength[pos] = atUint16(bestLength);
   }
+}
 
-  *pMatchPos = matchPos;
+LZ77Codec::LZ77Codec() : m_type10(2) {}
 
-  if (numBytes == 2)
-    numBytes = 1;
+void LZ77Codec::setMaxChainDepth(atInt32 maxChainDepth) {
+  m_type10.setMaxChainDepth(maxChainDepth);
+  m_type11.setMaxChainDepth(maxChainDepth);
+}
 
-  return numBytes;
+void LZ77Codec::setParseEffort(atInt32 parseEffort) {
+  m_type10.setParseEffort(parseEffort);
+  m_type11.setParseEffort(parseEffort);
 }
 
-atUint32 decompressLZ77(const atUint8* src, atUint32 srcLen, atUint8** dst) {
+atUint32 LZ77Codec::decompress(const atUint8* src, atUint32 srcLen, atUint8** dst) {
   if (*src == 0x11) {
-    return LZType11().decompress(src, dst, srcLen);
+    return m_type11.decompress(src, dst, srcLen);
   }
 
-  return LZType10(2).decompress(src, dst, srcLen);
+  return m_type10.decompress(src, dst, srcLen);
 }
 
-atUint32 compressLZ77(const atUint8* src, atUint32 srcLen, atUint8** dst, bool extended) {
+atUint32 LZ77Codec::compress(const atUint8* src, atUint32 srcLen, atUint8** dst, bool extended) {
   if (extended)
-    return LZType11().compress(src, dst, srcLen);
+    return m_type11.compress(src, dst, srcLen);
+
+  return m_type10.compress(src, dst, srcLen);
+}
+
+Status LZ77Codec::decompress(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen,
+                             size_t& decompressedLen) {
+  decompressedLen = 0;
+  if (srcLen && *src == 0x11)
+    return m_type11.decompressInto(src, srcLen, dst, dstLen, decompressedLen);
+
+  return m_type10.decompressInto(src, srcLen, dst, dstLen, decompressedLen);
+}
+
+Status LZ77Codec::decompress(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst) {
+  dst.clear();
+  size_t size, headerSize;
+  const Status header = LZBase::readHeader(src, srcLen, size, headerSize);
+  if (header != Status::Ok)
+    return header;
+
+  dst.resize(size);
+  size_t decompressedLen;
+  const Status status = decompress(src, srcLen, dst.data(), dst.size(), decompressedLen);
+  if (status != Status::Ok)
+    dst.clear();
+  return status;
+}
+
+Status LZ77Codec::compress(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst, bool extended) {
+  dst.clear();
+  // Type 0x10 stores the size in 24 bits, type 0x11 extends it to 32
+  if (srcLen > (extended ? UINT32_MAX : 0xFFFFFF))
+    return Status::InvalidArgument;
+
+  atUint8* out = nullptr;
+  const atUint32 len = compress(src, atUint32(srcLen), &out, extended);
+  if (!out)
+    return Status::Error;
+  dst.assign(out, out + len);
+  delete[] out;
+  return Status::Ok;
+}
+
+namespace {
+LZ77Codec& threadLZ77Codec() {
+  thread_local LZ77Codec codec;
+  return codec;
+}
+} // Anonymous namespace
+
+atUint32 decompressLZ77(const atUint8* src, atUint32 srcLen, atUint8** dst) {
+  return threadLZ77Codec().decompress(src, srcLen, dst);
+}
+
+atUint32 compressLZ77(const atUint8* src, atUint32 srcLen, atUint8** dst, bool extended) {
+  return threadLZ77Codec().compress(src, srcLen, dst, extended);
+}
+
+Status decompressLZ77(const atUint8* src, size_t srcLen, atUint8* dst, size_t dstLen, size_t& decompressedLen) {
+  return threadLZ77Codec().decompress(src, srcLen, dst, dstLen, decompressedLen);
+}
+
+Status decompressLZ77(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst) {
+  return threadLZ77Codec().decompress(src, srcLen, dst);
+}
 
-  return LZType10(2).compress(src, dst, srcLen);
+Status compressLZ77(const atUint8* src, size_t srcLen, std::vector<atUint8>& dst, bool extended) {
+  return threadLZ77Codec().compress(src, srcLen, dst, extended);
 }
 
 } // namespace athena::io::Compression
@@ -0,0 +1,329 @@
+#include "athena/DecompressReader.hpp"
+#include "athena/Compression.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace athena::io {
+namespace {
+constexpr atUint32 ChunkSize = 0x10000;
+constexpr atUint32 InputSize = 0x4000;
+
+constexpr atUint32 Yaz0History = 0x1000;
+constexpr atUint32 Yaz0MaxRun = 0xFF + 0x12;
+
+// Type 0x11 runs are far longer than type 0x10's, the buffer is sized before the header says which
+constexpr atUint32 LZ77History = 0x1000;
+constexpr atUint32 LZ77MaxRun = 0xFFFF + 0x111;
+} // Anonymous namespace
+
+DecompressReader::DecompressReader(std::unique_ptr<IStreamReader>&& source, atUint32 historySize, atUint32 maxRun,
+                                   bool globalErr)
+: m_source(std::move(source))
+, m_input(InputSize)
+, m_buffer(size_t(historySize) + ChunkSize + maxRun)
+, m_historySize(historySize)
+, m_maxRun(maxRun)
+, m_globalErr(globalErr) {
+  m_cur = m_end = m_buffer.data();
+}
+
+DecompressReader::~DecompressReader() = default;
+
+void DecompressReader::start() {
+  if (!m_source || m_source->hasError()) {
+    if (m_globalErr)
+      atError(fmt("Invalid decompression source"));
+    setError();
+    return;
+  }
+
+  m_sourceStart = m_source->position();
+  if (!rewind()) {
+    if (m_globalErr)
+      atError(fmt("Invalid compression header"));
+    setError();
+  }
+}
+
+bool DecompressReader::rewind() {
+  if (m_source->position() != m_sourceStart)
+    m_source->seek(m_sourceStart, SeekOrigin::Begin);
+  m_inCur = m_inEnd = m_input.data();
+  m_bufferOffset = 0;
+  m_cur = m_end = m_buffer.data();
+  m_length = 0;
+  return readHeader(m_length);
+}
+
+bool DecompressReader::fillInput() {
+  // Some sources treat reading past their end as an error
+  const atUint64 position = m_source->position();
+  const atUint64 remaining = m_source->length() > position ? m_source->length() - position : 0;
+  const atUint64 len =
+      remaining ? m_source->readUBytesToBuf(m_input.data(), std::min<atUint64>(m_input.size(), remaining)) : 0;
+  m_inCur = m_input.data();
+  m_inEnd = m_inCur + len;
+  return len != 0;
+}
+
+bool DecompressReader::copyMatch(atUint8* out, atUint32 dist, atUint32 len) const {
+  if (dist > atUint64(out - m_buffer.data()))
+    return false;
+
+  const atUint8* copySource = out - dist;
+  if (dist == 1) {
+    memset(out, *copySource, len);
+  } else if (dist >= len) {
+    memcpy(out, copySource, len);
+  } else {
+    for (atUint32 i = 0; i < len; ++i)
+      out[i] = copySource[i];
+  }
+  return true;
+}
+
+bool DecompressReader::refill(atUint64 len) {
+  if (hasError())
+    return false;
+
+  // Keep as much history as back-references can reach along with whatever is still unread
+  atUint8* const base = m_buffer.data();
+  const atUint8* const from = m_cur - std::min<atUint64>(m_historySize, atUint64(m_cur - base));
+  if (from != base) {
+    const atUint64 kept = atUint64(m_end - from);
+    memmove(base, from, kept);
+    m_bufferOffset += atUint64(from - base);
+    m_cur -= from - base;
+    m_end = base + kept;
+  }
+
+  atUint8* const bufferEnd = base + m_buffer.size();
+  atUint8* out = const_cast<atUint8*>(m_end);
+  while (atUint64(out - m_cur) < len) {
+    const atUint64 remaining = m_length - (m_bufferOffset + atUint64(out - base));
+    if (!remaining)
+      break;
+
+    atUint8* const end = atUint64(bufferEnd - out) > remaining ? out + remaining : bufferEnd;
+    atUint8* const limit = std::min(end, bufferEnd - m_maxRun);
+    if (out >= limit)
+      break;
+
+    atUint8* const decoded = decode(out, limit, end);
+    if (!decoded || (decoded == out && m_length != UnknownLength)) {
+      if (m_globalErr)
+        atError(fmt("Compressed data is corrupt or truncated"));
+      setError();
+      return false;
+    }
+
+    if (decoded == out) {
+      // Now the length is known
+      m_length = m_bufferOffset + atUint64(out - base);
+      break;
+    }
+    out = decoded;
+    m_end = out;
+  }
+
+  return atUint64(m_end - m_cur) >= len;
+}
+
+void DecompressReader::seek(atInt64 pos, SeekOrigin origin) {
+  atInt64 target = 0;
+  switch (origin) {
+  case SeekOrigin::Begin:
+    target = pos;
+    break;
+  case SeekOrigin::Current:
+    target = atInt64(position()) + pos;
+    break;
+  case SeekOrigin::End:
+    // Decode everything to find out where the end is
+    while (m_length == UnknownLength && !hasError()) {
+      m_cur = m_end;
+      refill(1);
+    }
+    target = atInt64(m_length) - pos;
+    break;
+  }
+
+  if (target < 0 || atUint64(target) > m_length || hasError()) {
+    if (m_globalErr)
+      atError(fmt("Unable to seek in stream"));
+    setError();
+    return;
+  }
+
+  if (atUint64(target) < m_bufferOffset && !rewind()) {
+    setError();
+    return;
+  }
+
+  // Decode forward until the target is in the buffer
+  while (atUint64(target) > m_bufferOffset + atUint64(m_end - m_buffer.data())) {
+    m_cur = m_end;
+    if (!refill(1))
+      return;
+  }
+  m_cur = m_buffer.data() + (atUint64(target) - m_bufferOffset);
+}
+
+atUint64 DecompressReader::readUBytesToBuf(void* buf, atUint64 len) {
+  atUint8* dst = reinterpret_cast<atUint8*>(buf);
+  atUint64 rem = len;
+  while (rem) {
+    if (m_cur == m_end && !refill(1))
+      break;
+
+    const atUint64 copySize = std::min(rem, atUint64(m_end - m_cur));
+    memcpy(dst, m_cur, copySize);
+    m_cur += copySize;
+    dst += copySize;
+    rem -= copySize;
+  }
+  return len - rem;
+}
+
+Yaz0Reader::Yaz0Reader(std::unique_ptr<IStreamReader>&& source, bool globalErr)
+: DecompressReader(std::move(source), Yaz0History, Yaz0MaxRun, globalErr) {
+  start();
+}
+
+bool Yaz0Reader::readHeader(atUint64& length) {
+  atUint8 header[Compression::Yaz0HeaderSize];
+  for (atUint8& val : header)
+    if (!nextByte(val))
+      return false;
+
+  if (Compression::yaz0PeekHeader(header, sizeof(header), length) != Compression::Status::Ok)
+    return false;
+
+  m_code = 0;
+  m_bits = 0;
+  return true;
+}
+
+atUint8* Yaz0Reader::decode(atUint8* out, atUint8* limit, atUint8* end) {
+  while (out < limit) {
+    // read new "code" byte if the current one is used up
+    if (m_bits == 0) {
+      if (!nextByte(m_code))
+        return nullptr;
+      m_bits = 8;
+    }
+
+    const bool straight = (m_code & 0x80) != 0;
+    m_code <<= 1;
+    --m_bits;
+
+    if (straight) {
+      if (!nextByte(*out))
+        return nullptr;
+      ++out;
+      continue;
+    }
+
+    // RLE part
+    atUint8 byte1, byte2;
+    if (!nextByte(byte1) || !nextByte(byte2))
+      return nullptr;
+
+    atUint32 numBytes = byte1 >> 4;
+    if (numBytes == 0) {
+      atUint8 byte3;
+      if (!nextByte(byte3))
+        return nullptr;
+      numBytes = byte3 + 0x12;
+    } else {
+      numBytes += 2;
+    }
+
+    const atUint32 dist = (((byte1 & 0xF) << 8) | byte2) + 1;
+    if (numBytes > atUint64(end - out) || !copyMatch(out, dist, numBytes))
+      return nullptr;
+    out += numBytes;
+  }
+  return out;
+}
+
+LZ77Reader::LZ77Reader(std::unique_ptr<IStreamReader>&& source, bool globalErr)
+: DecompressReader(std::move(source), LZ77History, LZ77MaxRun, globalErr) {
+  start();
+}
+
+bool LZ77Reader::readHeader(atUint64& length) {
+  atUint8 header[8];
+  size_t headerLen = 0;
+  for (; headerLen < 4; ++headerLen)
+    if (!nextByte(header[headerLen]))
+      return false;
+
+  // Type 0x11 stores sizes past 24 bits in the following word, an empty stream has no such word
+  if (header[0] == 0x11 && !header[1] && !header[2] && !header[3])
+    for (; headerLen < 8 && nextByte(header[headerLen]); ++headerLen) {}
+
+  size_t size, headerSize;
+  if (LZBase::readHeader(header, headerLen, size, headerSize) != Compression::Status::Ok)
+    return false;
+  length = size;
+
+  m_extended = header[0] == 0x11;
+  m_flags = 0;
+  m_bits = 0;
+  return true;
+}
+
+atUint8* LZ77Reader::decode(atUint8* out, atUint8* limit, atUint8* end) {
+  while (out < limit) {
+    if (m_bits == 0) {
+      if (!nextByte(m_flags))
+        return nullptr;
+      m_bits = 8;
+    }
+
+    const bool compressed = (m_flags & 0x80) != 0;
+    m_flags <<= 1;
+    --m_bits;
+
+    if (!compressed) {
+      if (!nextByte(*out))
+        return nullptr;
+      ++out;
+      continue;
+    }
+
+    atUint8 byte1, byte2;
+    if (!nextByte(byte1) || !nextByte(byte2))
+      return nullptr;
+
+    atUint32 length;
+    atUint32 lenOff = (byte1 << 8) | byte2;
+    if (!m_extended) {
+      length = (lenOff >> 12) + 3;
+    } else if ((byte1 >> 4) >= 2) { // Two Bytes of Length/Offset MetaData
+      length = (lenOff >> 12) + 1;
+    } else if ((byte1 >> 4) == 0) { // Three Bytes of Length/Offset MetaData
+      atUint8 byte3;
+      if (!nextByte(byte3))
+        return nullptr;
+      lenOff = (lenOff << 8) | byte3;
+      length = (lenOff >> 12) + 0x11;
+    } else { // Four Bytes of Length/Offset MetaData
+      atUint8 byte3, byte4;
+      if (!nextByte(byte3) || !nextByte(byte4))
+        return nullptr;
+      lenOff = (lenOff << 16) | (byte3 << 8) | byte4;
+      length = ((lenOff >> 12) & 0xFFFF) + 0x111;
+    }
+
+    const atUint32 dist = (lenOff & 0xFFF) + 1;
+    if (length > atUint64(end - out) || !copyMatch(out, dist, length))
+      return nullptr;
+    out += length;
+  }
+  return out;
+}
+
+} // namespace athena::io
@@ -1,5 +1,7 @@
 #include "athena/FileReader.hpp"
 
+#include <sys/stat.h>
+
 #if __APPLE__ || __FreeBSD__
 #include "osx_largefilewrapper.h"
 #elif GEKKO
@@ -9,14 +11,14 @@
 
 namespace athena::io {
 FileReader::FileReader(std::string_view filename, atInt32 cacheSize, bool globalErr)
-: m_fileHandle(nullptr), m_cacheData(nullptr), m_offset(0), m_globalErr(globalErr) {
+: m_fileHandle(nullptr), m_offset(0), m_globalErr(globalErr) {
   m_filename = filename;
   open();
   setCacheSize(cacheSize);
 }
 
 FileReader::FileReader(std::wstring_view filename, atInt32 cacheSize, bool globalErr)
-: m_fileHandle(nullptr), m_cacheData(nullptr), m_offset(0), m_globalErr(globalErr) {
+: m_fileHandle(nullptr), m_offset(0), m_globalErr(globalErr) {
   m_filename = utility::wideToUtf8(filename);
   open();
   setCacheSize(cacheSize);
@@ -38,6 +40,9 @@ void FileReader::open() {
     return;
   }
 
+  m_handleOffset = 0;
+  refreshLength();
+
   // reset error
   m_hasError = false;
 }
@@ -50,6 +55,7 @@ void FileReader::close() {
     return;
   }
 
+  syncWindow();
   fclose(m_fileHandle);
   m_fileHandle = NULL;
   return;
@@ -59,33 +65,9 @@ void FileReader::seek(atInt64 pos, SeekOrigin origin) {
   if (!isOpen())
     return;
 
-  // check block position
-  if (m_blockSize > 0) {
-    switch (origin) {
-    case SeekOrigin::Begin:
-      m_offset = pos;
-      break;
-    case SeekOrigin::Current:
-      m_offset += pos;
-      break;
-    case SeekOrigin::End:
-      m_offset = length() - pos;
-      break;
-    }
-    if (m_offset > length()) {
-      if (m_globalErr)
-        atError(fmt("Unable to seek in file"));
-      setError();
-      return;
-    }
-
-    size_t block = m_offset / m_blockSize;
-    if (atInt32(block) != m_curBlock) {
-      fseeko64(m_fileHandle, block * m_blockSize, SEEK_SET);
-      fread(m_cacheData.get(), 1, m_blockSize, m_fileHandle);
-      m_curBlock = atInt32(block);
-    }
-  } else if (fseeko64(m_fileHandle, pos, int(origin)) != 0) {
+  if (m_blockSize > 0)
+    seekCached(pos, origin);
+  else if (fseeko64(m_fileHandle, pos, int(origin)) != 0) {
     if (m_globalErr)
       atError(fmt("Unable to seek in file"));
     setError();
@@ -100,7 +82,7 @@ atUint64 FileReader::position() const {
   }
 
   if (m_blockSize > 0)
-    return m_offset;
+    return m_offset - atUint64(m_end - m_cur);
   else
     return atUint64(ftello64(m_fileHandle));
 }
@@ -112,7 +94,35 @@ atUint64 FileReader::length() const {
     return 0;
   }
 
-  return utility::fileSize(m_filename);
+  return m_length;
+}
+
+void FileReader::refreshLength() {
+  if (!isOpen())
+    return;
+
+  atStat64_t st;
+  if (atFStat64(fileno(m_fileHandle), &st) == 0)
+    m_length = st.st_size;
+  resetCache();
+}
+
+atUint64 FileReader::readAt(atUint64 offset, void* buf, atUint64 len) {
+  // Sequential block loads leave the handle where the next one starts; skip the redundant seek
+  if (offset != m_handleOffset) {
+    if (fseeko64(m_fileHandle, offset, SEEK_SET) != 0) {
+      m_handleOffset = atUint64(ftello64(m_fileHandle));
+      return 0;
+    }
+    m_handleOffset = offset;
+  }
+
+  if (!len)
+    return 0;
+
+  atUint64 ret = fread(buf, 1, len, m_fileHandle);
+  m_handleOffset += ret;
+  return ret;
 }
 
 atUint64 FileReader::readUBytesToBuf(void* buf, atUint64 len) {
@@ -125,51 +135,8 @@ atUint64 FileReader::readUBytesToBuf(void* buf, atUint64 len) {
 
   if (m_blockSize <= 0)
     return fread(buf, 1, len, m_fileHandle);
-  else {
-    atUint64 fs = utility::fileSize(m_filename);
-    if (m_offset >= fs)
-      return 0;
-    if (m_offset + len >= fs)
-      len = fs - m_offset;
-
-    size_t block = m_offset / m_blockSize;
-    atUint64 cacheOffset = m_offset % m_blockSize;
-    atUint64 cacheSize;
-    atUint64 rem = len;
-    atUint8* dst = (atUint8*)buf;
-
-    while (rem) {
-      if (atInt32(block) != m_curBlock) {
-        fseeko64(m_fileHandle, block * m_blockSize, SEEK_SET);
-        fread(m_cacheData.get(), 1, m_blockSize, m_fileHandle);
-        m_curBlock = atInt32(block);
-      }
-
-      cacheSize = rem;
-      if (atInt32(cacheSize + cacheOffset) > m_blockSize)
-        cacheSize = m_blockSize - cacheOffset;
-
-      memmove(dst, m_cacheData.get() + cacheOffset, cacheSize);
-      dst += cacheSize;
-      rem -= cacheSize;
-      cacheOffset = 0;
-      ++block;
-    }
-    m_offset += len;
-    return atUint64(dst - reinterpret_cast<atUint8*>(buf));
-  }
-}
 
-void FileReader::setCacheSize(const atInt32 blockSize) {
-  m_blockSize = blockSize;
-
-  atInt32 len = atInt32(length());
-  if (m_blockSize > len)
-    m_blockSize = len;
-
-  m_curBlock = -1;
-  if (m_blockSize > 0)
-    m_cacheData.reset(new atUint8[m_blockSize]);
+  return readCached(buf, len);
 }
 
 } // namespace athena::io
@@ -0,0 +1,175 @@
+#include "athena/FileReader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace athena::io {
+void FileReader::seekCached(atInt64 pos, SeekOrigin origin) {
+  syncWindow();
+  atUint64 offset = m_offset;
+  switch (origin) {
+  case SeekOrigin::Begin:
+    offset = pos;
+    break;
+  case SeekOrigin::Current:
+    offset += pos;
+    break;
+  case SeekOrigin::End:
+    offset = m_length - pos;
+    break;
+  }
+
+  if (offset > m_length) {
+    if (m_globalErr)
+      atError(fmt("Unable to seek in file"));
+    setError();
+    return;
+  }
+
+  // Blocks are loaded lazily on the next read
+  m_offset = offset;
+}
+
+const FileReader::CacheBlock& FileReader::cacheBlock(atUint64 index) {
+  // The block count is small, a linear scan beats any indexed structure here
+  CacheBlock* victim = &m_cacheBlocks[0];
+  for (CacheBlock& block : m_cacheBlocks) {
+    if (block.index == atInt64(index)) {
+      ++m_cacheHits;
+      block.lastUse = ++m_useCounter;
+      m_lastBlock = atInt64(index);
+      return block;
+    }
+    if (block.lastUse < victim->lastUse)
+      victim = &block;
+  }
+
+  ++m_cacheMisses;
+  const bool sequential = atInt64(index) == m_lastBlock + 1;
+  m_lastBlock = atInt64(index);
+
+  auto load = [this](CacheBlock& block, atUint64 idx) {
+    block.index = atInt64(idx);
+    block.size = readAt(idx * m_blockSize, block.data.get(), m_blockSize);
+    block.lastUse = ++m_useCounter;
+  };
+  load(*victim, index);
+  CacheBlock& ret = *victim;
+
+  if (sequential && m_readahead > 0) {
+    // Fill the following blocks while the handle is positioned right after this one
+    const atUint64 lastIndex = (m_length - 1) / m_blockSize;
+    atUint64 ahead = std::min<atUint64>(m_readahead, m_cacheBlocks.size() - 1);
+    for (atUint64 next = index + 1; ahead && next <= lastIndex; ++next, --ahead) {
+      CacheBlock* slot = nullptr;
+      for (CacheBlock& block : m_cacheBlocks) {
+        if (block.index == atInt64(next)) {
+          slot = nullptr;
+          break;
+        }
+        if (&block != &ret && (!slot || block.lastUse < slot->lastUse))
+          slot = &block;
+      }
+      if (!slot)
+        break;
+      load(*slot, next);
+    }
+    // Keep the demanded block ahead of its prefetched neighbours in LRU order
+    ret.lastUse = ++m_useCounter;
+  }
+
+  return ret;
+}
+
+atUint64 FileReader::readCached(void* buf, atUint64 len) {
+  syncWindow();
+  if (m_offset >= m_length)
+    return 0;
+  if (m_offset + len >= m_length)
+    len = m_length - m_offset;
+
+  atUint64 block = m_offset / m_blockSize;
+  atUint64 cacheOffset = m_offset % m_blockSize;
+  atUint64 rem = len;
+  atUint8* dst = reinterpret_cast<atUint8*>(buf);
+
+  while (rem) {
+    const CacheBlock& cache = cacheBlock(block);
+    if (cacheOffset >= cache.size)
+      break;
+
+    atUint64 cacheSize = std::min(rem, cache.size - cacheOffset);
+    memmove(dst, cache.data.get() + cacheOffset, cacheSize);
+    dst += cacheSize;
+    rem -= cacheSize;
+    cacheOffset = 0;
+    ++block;
+  }
+
+  atUint64 ret = atUint64(dst - reinterpret_cast<atUint8*>(buf));
+  m_offset += ret;
+  return ret;
+}
+
+bool FileReader::underflow(atUint64 len) {
+  if (m_blockSize <= 0 || !isOpen())
+    return false;
+
+  syncWindow();
+  if (m_offset >= m_length)
+    return false;
+
+  const CacheBlock& cache = cacheBlock(m_offset / m_blockSize);
+  const atUint64 cacheOffset = m_offset % m_blockSize;
+  // Reads straddling two blocks take the regular path
+  if (cacheOffset + len > cache.size)
+    return false;
+
+  // Expose the rest of the block; nothing evicts it before the next syncWindow()
+  m_cur = cache.data.get() + cacheOffset;
+  m_end = cache.data.get() + cache.size;
+  m_offset += cache.size - cacheOffset;
+  return true;
+}
+
+void FileReader::resetCache() {
+  syncWindow();
+  for (CacheBlock& block : m_cacheBlocks) {
+    block.index = -1;
+    block.size = 0;
+    block.lastUse = 0;
+  }
+  m_lastBlock = -1;
+}
+
+void FileReader::setCacheSize(const atInt32 blockSize) {
+  syncWindow();
+  if (isOpen() && m_blockSize <= 0) {
+    // Pick up where uncached reads left the OS handle
+    m_offset = position();
+    m_handleOffset = m_offset;
+  }
+
+  m_blockSize = blockSize;
+
+  if (m_blockSize > 0 && atUint64(m_blockSize) > m_length)
+    m_blockSize = atInt32(m_length);
+
+  m_cacheBlocks.clear();
+  m_lastBlock = -1;
+  if (m_blockSize > 0) {
+    m_cacheBlocks.resize(std::max(m_blockCount, 1));
+    for (CacheBlock& block : m_cacheBlocks)
+      block.data.reset(new atUint8[m_blockSize]);
+  } else if (isOpen()) {
+    // A zero-length read just positions the OS handle for uncached reads
+    readAt(m_offset, nullptr, 0);
+  }
+}
+
+void FileReader::setCacheBlockCount(const atInt32 blockCount) {
+  m_blockCount = std::max(blockCount, 1);
+  setCacheSize(m_blockSize);
+}
+
+} // namespace athena::io
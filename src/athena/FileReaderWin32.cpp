@@ -3,14 +3,14 @@
 
 namespace athena::io {
 FileReader::FileReader(std::string_view filename, atInt32 cacheSize, bool globalErr)
-: m_fileHandle(nullptr), m_cacheData(nullptr), m_offset(0), m_globalErr(globalErr) {
+: m_fileHandle(nullptr), m_offset(0), m_globalErr(globalErr) {
   m_filename = utility::utf8ToWide(filename);
   open();
   setCacheSize(cacheSize);
 }
 
 FileReader::FileReader(std::wstring_view filename, atInt32 cacheSize, bool globalErr)
-: m_fileHandle(nullptr), m_cacheData(nullptr), m_offset(0), m_globalErr(globalErr) {
+: m_fileHandle(nullptr), m_offset(0), m_globalErr(globalErr) {
   m_filename = filename;
   open();
   setCacheSize(cacheSize);
@@ -41,6 +41,8 @@ void FileReader::open() {
     return;
   }
 
+  refreshLength();
+
   // reset error
   m_hasError = false;
 }
@@ -53,6 +55,7 @@ void FileReader::close() {
     return;
   }
 
+  syncWindow();
   CloseHandle(m_fileHandle);
   m_fileHandle = 0;
   return;
@@ -62,38 +65,9 @@ void FileReader::seek(atInt64 pos, SeekOrigin origin) {
   if (!isOpen())
     return;
 
-  // check block position
-  if (m_blockSize > 0) {
-    atUint64 oldOff = m_offset;
-    switch (origin) {
-    case SeekOrigin::Begin:
-      m_offset = pos;
-      break;
-    case SeekOrigin::Current:
-      m_offset += pos;
-      break;
-    case SeekOrigin::End:
-      m_offset = length() - pos;
-      break;
-    }
-    if (m_offset > length()) {
-      oldOff = m_offset;
-      if (m_globalErr)
-        atError(fmt("Unable to seek in file"));
-      setError();
-      return;
-    }
-
-    size_t block = m_offset / m_blockSize;
-    if (block != m_curBlock) {
-      LARGE_INTEGER li;
-      li.QuadPart = block * m_blockSize;
-      SetFilePointerEx(m_fileHandle, li, nullptr, FILE_BEGIN);
-      DWORD readSz;
-      ReadFile(m_fileHandle, m_cacheData.get(), m_blockSize, &readSz, nullptr);
-      m_curBlock = (atInt32)block;
-    }
-  } else {
+  if (m_blockSize > 0)
+    seekCached(pos, origin);
+  else {
     LARGE_INTEGER li;
     li.QuadPart = pos;
     if (!SetFilePointerEx(m_fileHandle, li, nullptr, DWORD(origin))) {
@@ -112,7 +86,7 @@ atUint64 FileReader::position() const {
   }
 
   if (m_blockSize > 0)
-    return m_offset;
+    return m_offset - atUint64(m_end - m_cur);
   else {
     LARGE_INTEGER li = {};
     LARGE_INTEGER res;
@@ -128,9 +102,35 @@ atUint64 FileReader::length() const {
     return 0;
   }
 
+  return m_length;
+}
+
+void FileReader::refreshLength() {
+  if (!isOpen())
+    return;
+
   LARGE_INTEGER res;
-  GetFileSizeEx(m_fileHandle, &res);
-  return res.QuadPart;
+  if (GetFileSizeEx(m_fileHandle, &res))
+    m_length = res.QuadPart;
+  resetCache();
+}
+
+atUint64 FileReader::readAt(atUint64 offset, void* buf, atUint64 len) {
+  if (!len) {
+    LARGE_INTEGER li;
+    li.QuadPart = offset;
+    SetFilePointerEx(m_fileHandle, li, nullptr, FILE_BEGIN);
+    return 0;
+  }
+
+  // Positional read; no separate seek call needed
+  OVERLAPPED ov = {};
+  ov.Offset = DWORD(offset);
+  ov.OffsetHigh = DWORD(offset >> 32);
+  DWORD readSz = 0;
+  if (!ReadFile(m_fileHandle, buf, DWORD(len), &readSz, &ov))
+    return 0;
+  return readSz;
 }
 
 atUint64 FileReader::readUBytesToBuf(void* buf, atUint64 len) {
@@ -145,54 +145,9 @@ atUint64 FileReader::readUBytesToBuf(void* buf, atUint64 len) {
     DWORD ret = 0;
     ReadFile(m_fileHandle, buf, len, &ret, nullptr);
     return ret;
-  } else {
-    LARGE_INTEGER fs;
-    GetFileSizeEx(m_fileHandle, &fs);
-    if (m_offset >= atUint64(fs.QuadPart))
-      return 0;
-    if (m_offset + len >= atUint64(fs.QuadPart))
-      len = fs.QuadPart - m_offset;
-
-    size_t block = m_offset / m_blockSize;
-    atUint64 cacheOffset = m_offset % m_blockSize;
-    atUint64 cacheSize;
-    atUint64 rem = len;
-    atUint8* dst = (atUint8*)buf;
-
-    while (rem) {
-      if (block != m_curBlock) {
-        LARGE_INTEGER li;
-        li.QuadPart = block * m_blockSize;
-        SetFilePointerEx(m_fileHandle, li, nullptr, FILE_BEGIN);
-        DWORD readSz;
-        ReadFile(m_fileHandle, m_cacheData.get(), m_blockSize, &readSz, nullptr);
-        m_curBlock = (atInt32)block;
-      }
-
-      cacheSize = rem;
-      if (cacheSize + cacheOffset > m_blockSize)
-        cacheSize = m_blockSize - cacheOffset;
-
-      memmove(dst, m_cacheData.get() + cacheOffset, cacheSize);
-      dst += cacheSize;
-      rem -= cacheSize;
-      cacheOffset = 0;
-      ++block;
-    }
-    m_offset += len;
-    return dst - (atUint8*)buf;
   }
-}
 
-void FileReader::setCacheSize(const atInt32 blockSize) {
-  m_blockSize = blockSize;
-
-  if (m_blockSize > length())
-    m_blockSize = (atInt32)length();
-
-  m_curBlock = -1;
-  if (m_blockSize > 0)
-    m_cacheData.reset(new atUint8[m_blockSize]);
+  return readCached(buf, len);
 }
 
 } // namespace athena::io
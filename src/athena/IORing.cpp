@@ -0,0 +1,344 @@
+#include "athena/IORing.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(IORING_FEAT_RW_CUR_POS) && defined(__NR_io_uring_setup)
+#define AT_IO_URING 1
+#endif
+#endif
+
+namespace athena::io {
+namespace {
+// Linux caps a single read or write at just under 2 GiB
+constexpr atUint64 MaxTransfer = 0x7FFFF000;
+
+#if AT_IO_URING
+// liburing is deliberately not a dependency; the three system calls are all it wraps for us
+int ringSetup(atUint32 entries, io_uring_params* params) {
+  return int(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ringEnter(int fd, atUint32 toSubmit, atUint32 minComplete, atUint32 flags) {
+  return int(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int ringRegister(int fd, atUint32 opcode, const void* arg, atUint32 count) {
+  return int(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+void* ringMap(int fd, atUint64 size, atUint64 offset) {
+  void* ret = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, off_t(offset));
+  return ret == MAP_FAILED ? nullptr : ret;
+}
+
+template <typename T>
+T* ringPtr(void* ring, atUint32 offset) {
+  return reinterpret_cast<T*>(reinterpret_cast<atUint8*>(ring) + offset);
+}
+#endif
+} // Anonymous namespace
+
+IORing::IORing(atUint32 entries, bool fallback) : m_entries(std::max(entries, 1u)) {
+  if (!fallback)
+    setup();
+}
+
+IORing::~IORing() { teardown(); }
+
+void IORing::setup() {
+#if AT_IO_URING
+  io_uring_params params = {};
+  int fd = ringSetup(m_entries, &params);
+  if (fd < 0)
+    return;
+
+  // IORING_OP_READ/WRITE arrived in the same kernel as this feature bit
+  if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+    ::close(fd);
+    return;
+  }
+
+  m_ringFd = fd;
+  m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(atUint32);
+  m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+    m_sqRing = ringMap(fd, m_sqRingSize, IORING_OFF_SQ_RING);
+    m_cqRing = m_sqRing;
+  } else {
+    m_sqRing = ringMap(fd, m_sqRingSize, IORING_OFF_SQ_RING);
+    m_cqRing = ringMap(fd, m_cqRingSize, IORING_OFF_CQ_RING);
+  }
+  m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+  m_sqes = ringMap(fd, m_sqesSize, IORING_OFF_SQES);
+
+  if (!m_sqRing || !m_cqRing || !m_sqes) {
+    teardown();
+    return;
+  }
+
+  m_entries = params.sq_entries;
+  m_sqHead = ringPtr<atUint32>(m_sqRing, params.sq_off.head);
+  m_sqTail = ringPtr<atUint32>(m_sqRing, params.sq_off.tail);
+  m_sqArray = ringPtr<atUint32>(m_sqRing, params.sq_off.array);
+  m_sqMask = *ringPtr<atUint32>(m_sqRing, params.sq_off.ring_mask);
+  m_cqHead = ringPtr<atUint32>(m_cqRing, params.cq_off.head);
+  m_cqTail = ringPtr<atUint32>(m_cqRing, params.cq_off.tail);
+  m_cqMask = *ringPtr<atUint32>(m_cqRing, params.cq_off.ring_mask);
+  m_cqes = ringPtr<io_uring_cqe>(m_cqRing, params.cq_off.cqes);
+#endif
+}
+
+void IORing::teardown() {
+#if AT_IO_URING
+  if (m_ringFd < 0)
+    return;
+
+  // Closing the ring waits out any request still in flight
+  if (m_sqes)
+    munmap(m_sqes, m_sqesSize);
+  if (m_cqRing && m_cqRing != m_sqRing)
+    munmap(m_cqRing, m_cqRingSize);
+  if (m_sqRing)
+    munmap(m_sqRing, m_sqRingSize);
+  ::close(m_ringFd);
+
+  m_ringFd = -1;
+  m_sqRing = m_cqRing = m_sqes = m_cqes = nullptr;
+  m_inFlight = 0;
+  m_toSubmit = 0;
+  m_buffersRegistered = false;
+#endif
+}
+
+atUint32 IORing::queued() const { return isAsync() ? m_toSubmit : atUint32(m_pending.size()); }
+
+bool IORing::registerBuffers(const std::vector<Buffer>& buffers) {
+  unregisterBuffers();
+#if AT_IO_URING
+  if (!isAsync() || buffers.empty())
+    return false;
+
+  std::vector<iovec> iovs;
+  iovs.reserve(buffers.size());
+  for (const Buffer& buffer : buffers)
+    iovs.push_back({buffer.data, size_t(buffer.size)});
+
+  // Fails when the buffers exceed RLIMIT_MEMLOCK; plain requests still work then
+  m_buffersRegistered = ringRegister(m_ringFd, IORING_REGISTER_BUFFERS, iovs.data(), atUint32(iovs.size())) == 0;
+  return m_buffersRegistered;
+#else
+  return false;
+#endif
+}
+
+void IORing::unregisterBuffers() {
+#if AT_IO_URING
+  if (m_buffersRegistered)
+    ringRegister(m_ringFd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+#endif
+  m_buffersRegistered = false;
+}
+
+bool IORing::queueRead(int fd, void* buf, atUint32 len, atUint64 offset, atUint64 userData, atInt32 bufIndex) {
+  return queue({Op::Read, fd, buf, len, offset, userData}, bufIndex);
+}
+
+bool IORing::queueWrite(int fd, const void* buf, atUint32 len, atUint64 offset, atUint64 userData,
+                        atInt32 bufIndex) {
+  return queue({Op::Write, fd, const_cast<void*>(buf), len, offset, userData}, bufIndex);
+}
+
+bool IORing::queue(const Request& req, atInt32 bufIndex) {
+  // Never let more requests out than the completion queue is guaranteed to hold
+  if (queued() + m_inFlight >= m_entries)
+    return false;
+
+  if (!isAsync()) {
+    m_pending.push_back(req);
+    return true;
+  }
+
+#if AT_IO_URING
+  const atUint32 tail = *m_sqTail;
+  const atUint32 index = tail & m_sqMask;
+  io_uring_sqe* sqe = reinterpret_cast<io_uring_sqe*>(m_sqes) + index;
+  memset(sqe, 0, sizeof(io_uring_sqe));
+
+  const bool fixed = bufIndex >= 0 && m_buffersRegistered;
+  switch (req.op) {
+  case Op::Read:
+    sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    break;
+  case Op::Write:
+    sqe->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    break;
+  case Op::Open:
+    sqe->opcode = IORING_OP_OPENAT;
+    sqe->open_flags = O_RDONLY | O_CLOEXEC;
+    break;
+  case Op::Close:
+    sqe->opcode = IORING_OP_CLOSE;
+    break;
+  }
+  sqe->fd = req.op == Op::Open ? AT_FDCWD : req.fd;
+  sqe->addr = reinterpret_cast<atUint64>(req.buf);
+  sqe->len = req.len;
+  sqe->off = req.offset;
+  sqe->user_data = req.userData;
+  if (fixed)
+    sqe->buf_index = atUint16(bufIndex);
+
+  m_sqArray[index] = index;
+  __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+  ++m_toSubmit;
+#endif
+  return true;
+}
+
+atInt64 IORing::runBlocking(const Request& req) {
+  switch (req.op) {
+  case Op::Open: {
+    int fd;
+    do
+      fd = ::open(reinterpret_cast<const char*>(req.buf), O_RDONLY | O_CLOEXEC);
+    while (fd < 0 && errno == EINTR);
+    return fd < 0 ? -errno : fd;
+  }
+  case Op::Close:
+    return ::close(req.fd) < 0 ? -errno : 0;
+  default:
+    break;
+  }
+
+  atUint8* buf = reinterpret_cast<atUint8*>(req.buf);
+  atUint64 done = 0;
+  while (done < req.len) {
+    ssize_t ret = req.op == Op::Write ? ::pwrite(req.fd, buf + done, req.len - done, off_t(req.offset + done))
+                                      : ::pread(req.fd, buf + done, req.len - done, off_t(req.offset + done));
+    if (ret < 0 && errno == EINTR)
+      continue;
+    if (ret < 0)
+      return done ? atInt64(done) : -errno;
+    if (ret == 0)
+      break;
+    done += atUint64(ret);
+  }
+  return atInt64(done);
+}
+
+atUint32 IORing::reap(const Completion& onComplete) {
+  atUint32 count = 0;
+#if AT_IO_URING
+  atUint32 head = *m_cqHead;
+  while (head != __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE)) {
+    const io_uring_cqe* cqe = reinterpret_cast<const io_uring_cqe*>(m_cqes) + (head & m_cqMask);
+    const atUint64 userData = cqe->user_data;
+    const atInt64 result = cqe->res;
+    __atomic_store_n(m_cqHead, ++head, __ATOMIC_RELEASE);
+    --m_inFlight;
+    ++count;
+    if (onComplete)
+      onComplete(userData, result);
+  }
+#endif
+  return count;
+}
+
+atUint32 IORing::submit(atUint32 waitFor, const Completion& onComplete) {
+  if (!isAsync()) {
+    // Move the queue aside so the callback may queue follow-up requests
+    std::vector<Request> pending;
+    pending.swap(m_pending);
+    for (const Request& req : pending) {
+      atInt64 result = runBlocking(req);
+      if (onComplete)
+        onComplete(req.userData, result);
+    }
+    return atUint32(pending.size());
+  }
+
+#if AT_IO_URING
+  atUint32 count = reap(onComplete);
+  waitFor = std::min(waitFor, count + m_toSubmit + m_inFlight);
+  while (m_toSubmit || count < waitFor) {
+    const atUint32 minComplete = count < waitFor ? waitFor - count : 0;
+    int ret = ringEnter(m_ringFd, m_toSubmit, minComplete, minComplete ? IORING_ENTER_GETEVENTS : 0);
+    if (ret < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+        // Completions are backed up or resources are short; drain and retry
+        count += reap(onComplete);
+        continue;
+      }
+      break;
+    }
+    m_toSubmit -= atUint32(ret);
+    m_inFlight += atUint32(ret);
+    count += reap(onComplete);
+  }
+  return count;
+#else
+  return 0;
+#endif
+}
+
+void IORing::readFiles(std::vector<FileRead>& reads) {
+  std::vector<int> fds(reads.size(), -1);
+  auto setResult = [&](atUint64 i, atInt64 result) {
+    // Keep the first error; short reads at end of file simply add up
+    if (result < 0) {
+      if (reads[i].result >= 0)
+        reads[i].result = result;
+    } else if (reads[i].result >= 0) {
+      reads[i].result += result;
+    }
+  };
+
+  // Open, read and close a queue's worth of files at a time, each step in one batch
+  for (size_t start = 0; start < reads.size(); start += m_entries) {
+    const size_t end = std::min(reads.size(), start + m_entries);
+
+    for (size_t i = start; i < end; ++i) {
+      reads[i].result = 0;
+      queue({Op::Open, -1, const_cast<char*>(reads[i].path.c_str()), 0, 0, i}, -1);
+    }
+    waitAll([&](atUint64 i, atInt64 result) {
+      if (result < 0)
+        reads[i].result = result;
+      else
+        fds[i] = int(result);
+    });
+
+    for (size_t i = start; i < end; ++i) {
+      if (fds[i] < 0)
+        continue;
+      atUint8* buf = reinterpret_cast<atUint8*>(reads[i].buf);
+      for (atUint64 done = 0; done < reads[i].len;) {
+        const atUint32 len = atUint32(std::min(reads[i].len - done, MaxTransfer));
+        if (!queueRead(fds[i], buf + done, len, reads[i].offset + done, i)) {
+          submit(1, setResult);
+          continue;
+        }
+        done += len;
+      }
+    }
+    waitAll(setResult);
+
+    for (size_t i = start; i < end; ++i)
+      if (fds[i] >= 0)
+        queue({Op::Close, fds[i], nullptr, 0, 0, i}, -1);
+    waitAll(nullptr);
+  }
+}
+
+} // namespace athena::io
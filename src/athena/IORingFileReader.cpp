@@ -0,0 +1,272 @@
+#include "athena/IORingFileReader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace athena::io {
+namespace {
+// Page aligned blocks also satisfy O_DIRECT should the descriptor ever use it
+constexpr std::align_val_t BlockAlignment{4096};
+// Marks completions of reads going straight into the caller's buffer
+constexpr atUint64 DirectRead = ~atUint64(0);
+constexpr atUint64 MaxTransfer = 0x7FFFF000;
+} // Anonymous namespace
+
+IORingFileReader::IORingFileReader(std::string_view filename, atInt32 blockSize, atInt32 blockCount, bool globalErr)
+: m_filename(filename)
+, m_ring(atUint32(std::max(blockCount, 1)))
+, m_blockSize(atUint32(std::max(blockSize, 1)))
+, m_readahead(std::max(blockCount, 1) / 2)
+, m_globalErr(globalErr) {
+  int fd = ::open(m_filename.c_str(), O_RDONLY | O_CLOEXEC);
+  atStat64_t st;
+  if (fd < 0 || atFStat64(fd, &st) != 0) {
+    if (fd >= 0)
+      ::close(fd);
+    if (m_globalErr)
+      atError(fmt("File not found '{}'"), m_filename);
+    setError();
+    return;
+  }
+  m_fd = fd;
+  m_length = atUint64(st.st_size);
+
+  m_blocks.resize(std::max(blockCount, 1));
+  m_storage = static_cast<atUint8*>(::operator new(size_t(m_blockSize) * m_blocks.size(), BlockAlignment));
+  std::vector<IORing::Buffer> buffers;
+  buffers.reserve(m_blocks.size());
+  for (size_t i = 0; i < m_blocks.size(); ++i) {
+    m_blocks[i].data = m_storage + size_t(m_blockSize) * i;
+    buffers.push_back({m_blocks[i].data, m_blockSize});
+  }
+  m_ring.registerBuffers(buffers);
+}
+
+IORingFileReader::~IORingFileReader() {
+  if (isOpen())
+    close();
+  if (m_storage)
+    ::operator delete(m_storage, BlockAlignment);
+}
+
+void IORingFileReader::close() {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError(fmt("Cannot close an unopened stream"));
+    setError();
+    return;
+  }
+
+  // Blocks still loading are written by the kernel, let them land first
+  m_ring.waitAll([this](atUint64 userData, atInt64 result) { complete(userData, result); });
+  ::close(m_fd);
+  m_fd = -1;
+}
+
+void IORingFileReader::setReadaheadBlocks(atInt32 blocks) { m_readahead = std::max(blocks, 0); }
+
+void IORingFileReader::seek(atInt64 pos, SeekOrigin origin) {
+  if (!isOpen())
+    return;
+
+  atUint64 offset = m_offset;
+  switch (origin) {
+  case SeekOrigin::Begin:
+    offset = pos;
+    break;
+  case SeekOrigin::Current:
+    offset += pos;
+    break;
+  case SeekOrigin::End:
+    offset = m_length - pos;
+    break;
+  }
+
+  if (offset > m_length) {
+    if (m_globalErr)
+      atError(fmt("Unable to seek in file"));
+    setError();
+    return;
+  }
+
+  m_offset = offset;
+}
+
+void IORingFileReader::complete(atUint64 userData, atInt64 result) {
+  if (userData == DirectRead) {
+    if (result < 0)
+      m_directError = true;
+    else
+      m_direct += atUint64(result);
+    return;
+  }
+
+  Block& block = m_blocks[userData];
+  block.loading = false;
+  if (result < 0) {
+    block.index = -1;
+    block.size = 0;
+  } else {
+    block.size = atUint64(result);
+  }
+}
+
+void IORingFileReader::wait(const Block& block) {
+  while (block.loading)
+    m_ring.submit(1, [this](atUint64 userData, atInt64 result) { complete(userData, result); });
+}
+
+IORingFileReader::Block* IORingFileReader::victim(const Block* keep) {
+  while (true) {
+    // The block count is small, a linear scan beats any indexed structure here
+    Block* ret = nullptr;
+    for (Block& block : m_blocks)
+      if (!block.loading && &block != keep && (!ret || block.lastUse < ret->lastUse))
+        ret = &block;
+    if (ret || !m_ring.inFlight())
+      return ret;
+
+    // Every other block is still being filled
+    m_ring.submit(1, [this](atUint64 userData, atInt64 result) { complete(userData, result); });
+  }
+}
+
+void IORingFileReader::fetch(Block& block, atUint64 index) {
+  const atUint64 slot = atUint64(&block - m_blocks.data());
+  const atUint64 offset = index * m_blockSize;
+  block.index = atInt64(index);
+  block.size = 0;
+  block.loading = true;
+  block.lastUse = ++m_useCounter;
+
+  const atUint32 len = atUint32(std::min<atUint64>(m_blockSize, m_length - offset));
+  while (!m_ring.queueRead(m_fd, block.data, len, offset, slot, atInt32(slot)))
+    m_ring.submit(1, [this](atUint64 userData, atInt64 result) { complete(userData, result); });
+}
+
+void IORingFileReader::prefetch(atUint64 first, const Block* keep) {
+  const atUint64 lastIndex = (m_length - 1) / m_blockSize;
+  const atUint64 count = std::min<atUint64>(m_readahead, m_blocks.size() - 1);
+  for (atUint64 next = first; next < first + count && next <= lastIndex; ++next) {
+    bool cached = false;
+    for (const Block& block : m_blocks)
+      cached |= block.index == atInt64(next);
+    if (cached)
+      continue;
+
+    Block* slot = victim(keep);
+    if (!slot)
+      break;
+    fetch(*slot, next);
+  }
+
+  // Hand the batch to the kernel without waiting on it
+  if (m_ring.queued())
+    m_ring.submit(0, [this](atUint64 userData, atInt64 result) { complete(userData, result); });
+}
+
+const IORingFileReader::Block& IORingFileReader::block(atUint64 index) {
+  const bool sequential = atInt64(index) == m_lastBlock + 1;
+  m_lastBlock = atInt64(index);
+
+  for (Block& block : m_blocks) {
+    if (block.index == atInt64(index)) {
+      ++m_cacheHits;
+      block.lastUse = ++m_useCounter;
+      // Moving onto a prefetched block keeps the window ahead of the reader full
+      if (sequential && m_readahead > 0)
+        prefetch(index + 1, &block);
+      wait(block);
+      return block;
+    }
+  }
+
+  ++m_cacheMisses;
+  Block& block = *victim(nullptr);
+  fetch(block, index);
+  if (sequential && m_readahead > 0)
+    prefetch(index + 1, &block);
+  wait(block);
+
+  // Keep the demanded block ahead of its prefetched neighbours in LRU order
+  block.lastUse = ++m_useCounter;
+  return block;
+}
+
+atUint64 IORingFileReader::readDirect(void* buf, atUint64 len) {
+  auto onComplete = [this](atUint64 userData, atInt64 result) { complete(userData, result); };
+  atUint8* dst = reinterpret_cast<atUint8*>(buf);
+  m_direct = 0;
+  m_directError = false;
+
+  for (atUint64 done = 0; done < len;) {
+    const atUint32 chunk = atUint32(std::min(len - done, MaxTransfer));
+    if (!m_ring.queueRead(m_fd, dst + done, chunk, m_offset + done, DirectRead)) {
+      m_ring.submit(1, onComplete);
+      continue;
+    }
+    done += chunk;
+  }
+  m_ring.waitAll(onComplete);
+
+  if (m_directError) {
+    if (m_globalErr)
+      atError(fmt("Unable to read from file '{}'"), m_filename);
+    setError();
+  }
+
+  m_offset += m_direct;
+  return m_direct;
+}
+
+atUint64 IORingFileReader::readUBytesToBuf(void* buf, atUint64 len) {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError(fmt("File not open for reading"));
+    setError();
+    return 0;
+  }
+
+  if (m_offset >= m_length)
+    return 0;
+  len = std::min(len, m_length - m_offset);
+
+  // Large reads gain nothing from the cache
+  if (len >= m_blockSize)
+    return readDirect(buf, len);
+
+  atUint64 index = m_offset / m_blockSize;
+  atUint64 blockOffset = m_offset % m_blockSize;
+  atUint64 rem = len;
+  atUint8* dst = reinterpret_cast<atUint8*>(buf);
+
+  while (rem) {
+    const Block& cur = block(index);
+    if (cur.index != atInt64(index)) {
+      if (m_globalErr)
+        atError(fmt("Unable to read from file '{}'"), m_filename);
+      setError();
+      break;
+    }
+    if (blockOffset >= cur.size)
+      break;
+
+    atUint64 copySize = std::min(rem, cur.size - blockOffset);
+    memmove(dst, cur.data + blockOffset, copySize);
+    dst += copySize;
+    rem -= copySize;
+    blockOffset = 0;
+    ++index;
+  }
+
+  atUint64 ret = atUint64(dst - reinterpret_cast<atUint8*>(buf));
+  m_offset += ret;
+  return ret;
+}
+
+} // namespace athena::io
@@ -0,0 +1,217 @@
+#include "athena/IORingFileWriter.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace athena::io {
+namespace {
+constexpr std::align_val_t ChunkAlignment{4096};
+} // Anonymous namespace
+
+IORingFileWriter::IORingFileWriter(std::string_view filename, bool overwrite, atUint32 chunkSize,
+                                   atUint32 chunkCount, bool globalErr)
+: m_filename(filename)
+, m_ring(std::max(chunkCount, 1u))
+, m_chunkSize(std::max(chunkSize, 1u))
+, m_globalErr(globalErr) {
+  m_chunks.resize(std::max(chunkCount, 1u));
+  m_storage = static_cast<atUint8*>(::operator new(size_t(m_chunkSize) * m_chunks.size(), ChunkAlignment));
+  std::vector<IORing::Buffer> buffers;
+  buffers.reserve(m_chunks.size());
+  for (size_t i = 0; i < m_chunks.size(); ++i) {
+    m_chunks[i].data = m_storage + size_t(m_chunkSize) * i;
+    buffers.push_back({m_chunks[i].data, m_chunkSize});
+  }
+  m_ring.registerBuffers(buffers);
+
+  open(overwrite);
+}
+
+IORingFileWriter::~IORingFileWriter() {
+  if (isOpen())
+    close();
+  ::operator delete(m_storage, ChunkAlignment);
+}
+
+void IORingFileWriter::open(bool overwrite) {
+  m_overwrite = overwrite;
+  if (overwrite) {
+    std::string tmpFilename = m_filename + '~';
+    m_fd = ::open(tmpFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  } else {
+    m_fd = ::open(m_filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+  }
+
+  atStat64_t st;
+  if (m_fd < 0 || atFStat64(m_fd, &st) != 0) {
+    if (m_fd >= 0)
+      ::close(m_fd);
+    m_fd = -1;
+    if (m_globalErr)
+      atError(fmt("Unable to open file '{}'"), m_filename);
+    setError();
+    return;
+  }
+
+  m_position = 0;
+  m_length = atUint64(st.st_size);
+  m_current = 0;
+
+  // reset error
+  m_hasError = false;
+}
+
+void IORingFileWriter::close() {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError(fmt("Cannot close an unopened stream"));
+    setError();
+    return;
+  }
+
+  flush();
+  ::close(m_fd);
+  m_fd = -1;
+
+  if (m_overwrite) {
+    std::string tmpFilename = m_filename + '~';
+    rename(tmpFilename.c_str(), m_filename.c_str());
+  }
+}
+
+void IORingFileWriter::complete(atUint64 userData, atInt64 result) {
+  Chunk& chunk = m_chunks[userData];
+  bool failed = result < 0;
+  atUint64 done = failed ? 0 : atUint64(result);
+
+  // Short writes are rare enough to finish off synchronously
+  while (!failed && done < chunk.used) {
+    ssize_t ret = ::pwrite(m_fd, chunk.data + done, chunk.used - done, off_t(chunk.offset + done));
+    if (ret < 0 && errno == EINTR)
+      continue;
+    failed = ret <= 0;
+    if (!failed)
+      done += atUint64(ret);
+  }
+
+  if (failed) {
+    if (m_globalErr)
+      atError(fmt("Unable to write to stream"));
+    setError();
+  }
+
+  chunk.used = 0;
+  chunk.inFlight = false;
+}
+
+void IORingFileWriter::wait(const Chunk& chunk) {
+  while (chunk.inFlight)
+    m_ring.submit(1, [this](atUint64 userData, atInt64 result) { complete(userData, result); });
+}
+
+void IORingFileWriter::issue(Chunk& chunk) {
+  if (!chunk.used || chunk.inFlight)
+    return;
+
+  // The kernel does not order writes; one overlapping an earlier write still in flight must wait for it
+  const atUint64 end = chunk.offset + chunk.used;
+  for (const Chunk& other : m_chunks)
+    if (other.inFlight && other.offset < end && chunk.offset < other.offset + other.used)
+      wait(other);
+
+  auto onComplete = [this](atUint64 userData, atInt64 result) { complete(userData, result); };
+  const atUint64 slot = atUint64(&chunk - m_chunks.data());
+  chunk.inFlight = true;
+  while (!m_ring.queueWrite(m_fd, chunk.data, chunk.used, chunk.offset, slot, atInt32(slot)))
+    m_ring.submit(1, onComplete);
+  m_ring.submit(0, onComplete);
+}
+
+void IORingFileWriter::flush() {
+  if (!isOpen())
+    return;
+
+  Chunk& chunk = m_chunks[m_current];
+  if (chunk.used && !chunk.inFlight) {
+    issue(chunk);
+    m_current = (m_current + 1) % m_chunks.size();
+  }
+  m_ring.waitAll([this](atUint64 userData, atInt64 result) { complete(userData, result); });
+}
+
+void IORingFileWriter::seek(atInt64 pos, SeekOrigin origin) {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError(fmt("Unable to seek in file, not open"));
+    setError();
+    return;
+  }
+
+  atInt64 position = atInt64(m_position);
+  switch (origin) {
+  case SeekOrigin::Begin:
+    position = pos;
+    break;
+  case SeekOrigin::Current:
+    position += pos;
+    break;
+  case SeekOrigin::End:
+    position = atInt64(m_length) - pos;
+    break;
+  }
+
+  if (position < 0) {
+    if (m_globalErr)
+      atError(fmt("Unable to seek in file"));
+    setError();
+    return;
+  }
+
+  // Gathered bytes are written out lazily once the next write proves non-contiguous
+  m_position = atUint64(position);
+}
+
+void IORingFileWriter::writeUBytes(const atUint8* data, atUint64 len) {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError(fmt("File not open for writing"));
+    setError();
+    return;
+  }
+
+  while (len) {
+    Chunk* chunk = &m_chunks[m_current];
+    if (chunk->used && !chunk->inFlight && chunk->offset + chunk->used != m_position) {
+      // A seek broke the run, what was gathered so far goes out on its own
+      issue(*chunk);
+      m_current = (m_current + 1) % m_chunks.size();
+      chunk = &m_chunks[m_current];
+    }
+
+    wait(*chunk);
+    if (!chunk->used)
+      chunk->offset = m_position;
+
+    const atUint32 copySize = atUint32(std::min<atUint64>(len, m_chunkSize - chunk->used));
+    memcpy(chunk->data + chunk->used, data, copySize);
+    chunk->used += copySize;
+    data += copySize;
+    len -= copySize;
+    m_position += copySize;
+    m_length = std::max(m_length, m_position);
+
+    if (chunk->used == m_chunkSize) {
+      issue(*chunk);
+      m_current = (m_current + 1) % m_chunks.size();
+    }
+  }
+}
+
+} // namespace athena::io
@@ -7,14 +7,15 @@ namespace io {
 static const atUint32 SCRAMBLE_VALUE = 0x5A424741;
 MCFileReader::MCFileReader(atUint8* data, atUint64 length) : MemoryCopyReader(data, length) {}
 
-MCFileReader::MCFileReader(const std::string& filename) : MemoryCopyReader(filename) {}
+MCFileReader::MCFileReader(const std::string& filename, bool mapFile)
+: MemoryCopyReader(filename, mapFile ? Load::Map : Load::Copy) {}
 
 MCFile* MCFileReader::readFile() {
   bool isScrambled = readUint32() != SCRAMBLE_VALUE;
-  m_position = 0;
+  seek(0, SeekOrigin::Begin);
 
   if (isScrambled)
-    MCFile::unscramble(m_dataCopy.get(), m_length);
+    MCFile::unscramble(mutableData(), m_length);
 
   return nullptr;
 }
@@ -0,0 +1,156 @@
+#include "athena/MappedFileReader.hpp"
+
+#include <cstdio>
+#include <limits>
+
+#if defined(GEKKO) || defined(__SWITCH__)
+#include "gekko_support.h"
+#define AT_NO_MMAP 1
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace athena::io {
+#if !AT_NO_MMAP
+static int adviceFlag(MapAdvice advice) {
+  switch (advice) {
+  case MapAdvice::Sequential:
+    return MADV_SEQUENTIAL;
+  case MapAdvice::Random:
+    return MADV_RANDOM;
+  case MapAdvice::WillNeed:
+    return MADV_WILLNEED;
+  default:
+    return MADV_NORMAL;
+  }
+}
+#endif
+
+MappedFileReader::MappedFileReader(std::string_view filename, bool copyOnWrite, MapAdvice advice, bool globalErr)
+: m_filename(filename), m_copyOnWrite(copyOnWrite), m_advice(advice) {
+  m_globalErr = globalErr;
+  open();
+}
+
+MappedFileReader::~MappedFileReader() {
+  if (isOpen())
+    close();
+}
+
+void MappedFileReader::open() {
+#if AT_NO_MMAP
+  // No mmap on this target; fall back to a private heap copy
+  FILE* in = fopen(m_filename.c_str(), "rb");
+  if (!in) {
+    if (m_globalErr)
+      atError(fmt("File not found '{}'"), m_filename);
+    setError();
+    return;
+  }
+
+  atUint64 length = utility::fileSize(m_filename);
+  atUint8* buf = new atUint8[length ? length : 1];
+  if (fread(buf, 1, length, in) != length) {
+    delete[] buf;
+    fclose(in);
+    if (m_globalErr)
+      atError(fmt("Error reading data from disk"));
+    setError();
+    return;
+  }
+  fclose(in);
+  m_mapping = buf;
+  m_length = length;
+#else
+  int fd = ::open(m_filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    if (m_globalErr)
+      atError(fmt("File not found '{}'"), m_filename);
+    setError();
+    return;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || atUint64(st.st_size) > std::numeric_limits<size_t>::max()) {
+    ::close(fd);
+    if (m_globalErr)
+      atError(fmt("Unable to map file '{}'"), m_filename);
+    setError();
+    return;
+  }
+
+  m_length = atUint64(st.st_size);
+  if (m_length == 0) {
+    // Zero-length mappings are invalid; an empty stream needs no backing store
+    ::close(fd);
+    resetWindow();
+    m_hasError = false;
+    return;
+  }
+
+  int prot = m_copyOnWrite ? (PROT_READ | PROT_WRITE) : PROT_READ;
+  int flags = m_copyOnWrite ? MAP_PRIVATE : MAP_SHARED;
+  void* addr = mmap(nullptr, size_t(m_length), prot, flags, fd, 0);
+  // The mapping holds its own reference to the file
+  ::close(fd);
+
+  if (addr == MAP_FAILED) {
+    m_length = 0;
+    if (m_globalErr)
+      atError(fmt("Unable to map file '{}'"), m_filename);
+    setError();
+    return;
+  }
+
+  m_mapping = addr;
+  if (m_advice != MapAdvice::Normal)
+    madvise(m_mapping, size_t(m_length), adviceFlag(m_advice));
+#endif
+
+  m_data = m_mapping;
+  resetWindow();
+  m_owns = false;
+
+  // reset error
+  m_hasError = false;
+}
+
+void MappedFileReader::close() {
+  if (!m_mapping) {
+    if (m_globalErr)
+      atError(fmt("Cannot close an unopened stream"));
+    setError();
+    return;
+  }
+
+#if AT_NO_MMAP
+  delete[] static_cast<atUint8*>(m_mapping);
+#else
+  munmap(m_mapping, size_t(m_length));
+#endif
+  m_mapping = nullptr;
+  m_data = nullptr;
+  m_length = 0;
+  resetWindow();
+}
+
+void MappedFileReader::advise(MapAdvice advice, atUint64 offset, atUint64 length) {
+#if !AT_NO_MMAP
+  if (!m_mapping || offset >= m_length)
+    return;
+
+  if (length == 0 || length > m_length - offset)
+    length = m_length - offset;
+
+  // madvise requires a page-aligned start address
+  atUint64 pageMask = atUint64(sysconf(_SC_PAGESIZE)) - 1;
+  atUint64 alignedOffset = offset & ~pageMask;
+  madvise(static_cast<atUint8*>(m_mapping) + alignedOffset, size_t(length + offset - alignedOffset),
+          adviceFlag(advice));
+#endif
+}
+
+} // namespace athena::io
@@ -0,0 +1,109 @@
+#include "athena/MappedFileReader.hpp"
+
+namespace athena::io {
+MappedFileReader::MappedFileReader(std::string_view filename, bool copyOnWrite, MapAdvice advice, bool globalErr)
+: m_filename(filename), m_copyOnWrite(copyOnWrite), m_advice(advice) {
+  m_globalErr = globalErr;
+  open();
+}
+
+MappedFileReader::~MappedFileReader() {
+  if (isOpen())
+    close();
+}
+
+void MappedFileReader::open() {
+  std::wstring wfilename = utility::utf8ToWide(m_filename);
+  // Windows has no per-range advice; the closest equivalent is a hint on the file handle
+  DWORD flags = FILE_ATTRIBUTE_NORMAL;
+  if (m_advice == MapAdvice::Sequential)
+    flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+  else if (m_advice == MapAdvice::Random)
+    flags |= FILE_FLAG_RANDOM_ACCESS;
+
+#if WINDOWS_STORE
+  CREATEFILE2_EXTENDED_PARAMETERS params = {};
+  params.dwSize = sizeof(params);
+  params.dwFileAttributes = FILE_ATTRIBUTE_NORMAL;
+  params.dwFileFlags = flags & ~FILE_ATTRIBUTE_NORMAL;
+  m_fileHandle = CreateFile2(wfilename.c_str(), GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, &params);
+#else
+  m_fileHandle = CreateFileW(wfilename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+#endif
+  if (m_fileHandle == INVALID_HANDLE_VALUE) {
+    if (m_globalErr)
+      atError(fmt("File not found '{}'"), m_filename);
+    setError();
+    return;
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(m_fileHandle, &size)) {
+    CloseHandle(m_fileHandle);
+    m_fileHandle = INVALID_HANDLE_VALUE;
+    if (m_globalErr)
+      atError(fmt("Unable to map file '{}'"), m_filename);
+    setError();
+    return;
+  }
+
+  m_length = atUint64(size.QuadPart);
+  if (m_length == 0) {
+    // Zero-length mappings are invalid; an empty stream needs no backing store
+    CloseHandle(m_fileHandle);
+    m_fileHandle = INVALID_HANDLE_VALUE;
+    resetWindow();
+    m_hasError = false;
+    return;
+  }
+
+  m_mapHandle = CreateFileMappingW(m_fileHandle, nullptr, m_copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0,
+                                   nullptr);
+  if (m_mapHandle)
+    m_mapping = MapViewOfFile(m_mapHandle, m_copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+
+  if (!m_mapping) {
+    if (m_mapHandle)
+      CloseHandle(m_mapHandle);
+    CloseHandle(m_fileHandle);
+    m_mapHandle = nullptr;
+    m_fileHandle = INVALID_HANDLE_VALUE;
+    m_length = 0;
+    if (m_globalErr)
+      atError(fmt("Unable to map file '{}'"), m_filename);
+    setError();
+    return;
+  }
+
+  m_data = m_mapping;
+  resetWindow();
+  m_owns = false;
+
+  // reset error
+  m_hasError = false;
+}
+
+void MappedFileReader::close() {
+  if (!m_mapping) {
+    if (m_globalErr)
+      atError(fmt("Cannot close an unopened stream"));
+    setError();
+    return;
+  }
+
+  UnmapViewOfFile(m_mapping);
+  CloseHandle(m_mapHandle);
+  CloseHandle(m_fileHandle);
+  m_mapping = nullptr;
+  m_mapHandle = nullptr;
+  m_fileHandle = INVALID_HANDLE_VALUE;
+  m_data = nullptr;
+  m_length = 0;
+  resetWindow();
+}
+
+void MappedFileReader::advise(MapAdvice, atUint64, atUint64) {
+  // Access pattern is fixed when the file handle is opened
+}
+
+} // namespace athena::io
@@ -1,4 +1,5 @@
 #include "athena/MemoryReader.hpp"
+#include "athena/MappedFileReader.hpp"
 
 #include <algorithm>
 #include <cstdio>
@@ -10,13 +11,15 @@
 
 namespace athena::io {
 MemoryReader::MemoryReader(const void* data, atUint64 length, bool takeOwnership, bool globalErr)
-: m_data(data), m_length(length), m_position(0), m_owns(takeOwnership), m_globalErr(globalErr) {
+: m_data(data), m_length(length), m_owns(takeOwnership), m_globalErr(globalErr) {
   if (!data) {
     if (m_globalErr)
       atError(fmt("data cannot be NULL"));
     setError();
     return;
   }
+
+  resetWindow();
 }
 
 MemoryReader::~MemoryReader() {
@@ -35,44 +38,56 @@ MemoryCopyReader::MemoryCopyReader(const void* data, atUint64 length) : MemoryRe
   m_dataCopy.reset(new atUint8[m_length]);
   m_data = m_dataCopy.get();
   memmove(m_dataCopy.get(), data, m_length);
+  resetWindow();
+}
+
+MemoryCopyReader::MemoryCopyReader(const std::string& filename, Load load) : m_filepath(filename) {
+  if (load == Load::Map)
+    mapData();
+  else
+    loadData();
 }
 
+MemoryCopyReader::~MemoryCopyReader() = default;
+
 void MemoryReader::seek(atInt64 position, SeekOrigin origin) {
+  const atUint8* begin = static_cast<const atUint8*>(m_data);
+  const atUint64 current = MemoryReader::position();
   switch (origin) {
   case SeekOrigin::Begin:
     if ((position < 0 || atInt64(position) > atInt64(m_length))) {
       if (m_globalErr)
         atFatal(fmt("Position {:08X} outside stream bounds "), position);
-      m_position = m_length;
+      m_cur = m_end;
       setError();
       return;
     }
 
-    m_position = atUint64(position);
+    m_cur = begin + position;
     break;
 
   case SeekOrigin::Current:
-    if (((atInt64(m_position) + position) < 0 || (m_position + atUint64(position)) > m_length)) {
+    if (((atInt64(current) + position) < 0 || (current + atUint64(position)) > m_length)) {
       if (m_globalErr)
         atFatal(fmt("Position {:08X} outside stream bounds "), position);
-      m_position = (position < 0 ? 0 : m_length);
+      m_cur = (position < 0 ? begin : m_end);
       setError();
       return;
     }
 
-    m_position += position;
+    m_cur += position;
     break;
 
   case SeekOrigin::End:
     if ((((atInt64)m_length - position < 0) || (m_length - position) > m_length)) {
       if (m_globalErr)
         atFatal(fmt("Position {:08X} outside stream bounds "), position);
-      m_position = m_length;
+      m_cur = m_end;
       setError();
       return;
     }
 
-    m_position = m_length - position;
+    m_cur = begin + (m_length - position);
     break;
   }
 }
@@ -82,16 +97,17 @@ void MemoryReader::setData(const atUint8* data, atUint64 length, bool takeOwners
     delete[] static_cast<const atUint8*>(m_data);
   m_data = (atUint8*)data;
   m_length = length;
-  m_position = 0;
   m_owns = takeOwnership;
+  resetWindow();
 }
 
 void MemoryCopyReader::setData(const atUint8* data, atUint64 length) {
   m_dataCopy.reset(new atUint8[length]);
   m_data = m_dataCopy.get();
   memmove(m_dataCopy.get(), data, length);
+  m_mappedFile.reset();
   m_length = length;
-  m_position = 0;
+  resetWindow();
 }
 
 atUint8* MemoryReader::data() const {
@@ -102,17 +118,18 @@ atUint8* MemoryReader::data() const {
 }
 
 atUint64 MemoryReader::readUBytesToBuf(void* buf, atUint64 length) {
-  if (m_position >= m_length) {
+  const atUint64 position = MemoryReader::position();
+  if (position >= m_length) {
     if (m_globalErr)
-      atFatal(fmt("Position {:08X} outside stream bounds "), m_position);
-    m_position = m_length;
+      atFatal(fmt("Position {:08X} outside stream bounds "), position);
+    m_cur = m_end;
     setError();
     return 0;
   }
 
-  length = std::min(length, m_length - m_position);
-  memmove(buf, reinterpret_cast<const atUint8*>(m_data) + m_position, length);
-  m_position += length;
+  length = std::min(length, m_length - position);
+  memmove(buf, m_cur, length);
+  m_cur += length;
   return length;
 }
 
@@ -157,7 +174,27 @@ void MemoryCopyReader::loadData() {
 
   fclose(in);
   m_length = length;
-  m_position = 0;
+  resetWindow();
+}
+
+void MemoryCopyReader::mapData() {
+  // The private mapping stands in for the heap copy; edits never reach the file
+  m_mappedFile = std::make_unique<MappedFileReader>(m_filepath, true, MapAdvice::Sequential, m_globalErr);
+  if (m_mappedFile->hasError()) {
+    m_mappedFile.reset();
+    setError();
+    return;
+  }
+
+  m_data = m_mappedFile->mutableData();
+  m_length = m_mappedFile->length();
+  resetWindow();
+}
+
+atUint8* MemoryCopyReader::mutableData() const {
+  if (m_mappedFile)
+    return m_mappedFile->mutableData();
+  return m_dataCopy.get();
 }
 
 } // namespace athena::io
@@ -0,0 +1,31 @@
+#include "athena/ParallelFor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace athena {
+atUint32 parallelThreads(size_t count, atUint32 threads) {
+  if (threads == 0)
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+  return atUint32(std::max<size_t>(std::min<size_t>(threads, count), 1));
+}
+
+void parallelFor(size_t count, atUint32 threads, const std::function<void(atUint32 worker, size_t index)>& fn) {
+  threads = parallelThreads(count, threads);
+  std::atomic<size_t> next{0};
+  const auto work = [&](atUint32 worker) {
+    for (size_t i = next++; i < count; i = next++)
+      fn(worker, i);
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (atUint32 i = 1; i < threads; ++i)
+    workers.emplace_back(work, i);
+  work(0);
+  for (std::thread& worker : workers)
+    worker.join();
+}
+} // namespace athena
@@ -0,0 +1,266 @@
+#include "athena/PositionalFileReader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace athena::io {
+PositionalFileReader::Shared::~Shared() {
+#if _WIN32
+  if (handle)
+    CloseHandle(handle);
+#else
+  if (fd >= 0)
+    ::close(fd);
+#endif
+}
+
+atUint64 PositionalFileReader::Shared::pread(atUint64 offset, void* buf, atUint64 len) const {
+  atUint8* dst = reinterpret_cast<atUint8*>(buf);
+  atUint64 done = 0;
+  while (done < len) {
+#if _WIN32
+    // ReadFile with an explicit offset never consults the shared file pointer
+    OVERLAPPED ov = {};
+    ov.Offset = DWORD(offset + done);
+    ov.OffsetHigh = DWORD((offset + done) >> 32);
+    DWORD chunk = DWORD(std::min<atUint64>(len - done, 0x80000000));
+    DWORD ret = 0;
+    if (!ReadFile(handle, dst + done, chunk, &ret, &ov) || ret == 0)
+      break;
+#else
+    ssize_t ret = ::pread(fd, dst + done, size_t(len - done), off_t(offset + done));
+    if (ret < 0 && errno == EINTR)
+      continue;
+    if (ret <= 0)
+      break;
+#endif
+    done += atUint64(ret);
+  }
+  return done;
+}
+
+PositionalFileReader::BlockPtr PositionalFileReader::Shared::loadBlock(atUint64 index) {
+  {
+    std::lock_guard<std::mutex> lk(cacheLock);
+    auto search = lookup.find(index);
+    if (search != lookup.end()) {
+      ++hits;
+      lru.splice(lru.begin(), lru, search->second);
+      return *search->second;
+    }
+  }
+
+  // Read outside the lock so other cursors aren't held up by this miss;
+  // two cursors racing on the same block both read it and the first insert wins
+  ++misses;
+  auto block = std::make_shared<Block>();
+  block->index = index;
+  block->data.reset(new atUint8[blockSize]);
+  block->size = pread(index * blockSize, block->data.get(), blockSize);
+  BlockPtr ret = std::move(block);
+
+  std::lock_guard<std::mutex> lk(cacheLock);
+  auto search = lookup.find(index);
+  if (search != lookup.end())
+    return *search->second;
+
+  lru.push_front(ret);
+  lookup[index] = lru.begin();
+  while (lru.size() > size_t(cacheBlocks)) {
+    // Cursors still holding an evicted block keep it alive until they move on
+    lookup.erase(lru.back()->index);
+    lru.pop_back();
+  }
+  return ret;
+}
+
+PositionalFileReader::PositionalFileReader(std::string_view filename, atInt32 blockSize, atInt32 cacheBlocks,
+                                           bool globalErr)
+: m_shared(std::make_shared<Shared>()), m_globalErr(globalErr) {
+  m_shared->filename = filename;
+  m_shared->blockSize = std::max(blockSize, 1);
+  m_shared->cacheBlocks = std::max(cacheBlocks, 0);
+
+#if _WIN32
+  std::wstring wfilename = utility::utf8ToWide(m_shared->filename);
+  HANDLE handle = CreateFileW(wfilename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+  LARGE_INTEGER size;
+  if (handle != INVALID_HANDLE_VALUE && GetFileSizeEx(handle, &size)) {
+    m_shared->handle = handle;
+    m_shared->length = atUint64(size.QuadPart);
+  } else if (handle != INVALID_HANDLE_VALUE) {
+    CloseHandle(handle);
+  }
+#else
+  int fd = ::open(m_shared->filename.c_str(), O_RDONLY);
+  atStat64_t st;
+  if (fd >= 0 && atFStat64(fd, &st) == 0) {
+    m_shared->fd = fd;
+    m_shared->length = atUint64(st.st_size);
+  } else if (fd >= 0) {
+    ::close(fd);
+  }
+#endif
+
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError(fmt("File not found '{}'"), m_shared->filename);
+    setError();
+  }
+}
+
+PositionalFileReader::PositionalFileReader(std::shared_ptr<Shared> shared, atUint64 offset, bool globalErr)
+: m_shared(std::move(shared)), m_offset(offset), m_globalErr(globalErr) {}
+
+PositionalFileReader::PositionalFileReader(const PositionalFileReader& other)
+: IStreamReader(other)
+, m_shared(other.m_shared)
+, m_block(other.m_block)
+, m_offset(other.m_offset)
+, m_globalErr(other.m_globalErr) {}
+
+PositionalFileReader& PositionalFileReader::operator=(const PositionalFileReader& other) {
+  IStreamReader::operator=(other);
+  m_shared = other.m_shared;
+  m_block = other.m_block;
+  m_offset = other.m_offset;
+  m_globalErr = other.m_globalErr;
+  return *this;
+}
+
+PositionalFileReader PositionalFileReader::cursor(atUint64 offset) const {
+  PositionalFileReader ret(m_shared, offset, m_globalErr);
+  ret.setEndian(m_endian);
+  return ret;
+}
+
+std::string PositionalFileReader::filename() const { return m_shared ? m_shared->filename : std::string(); }
+
+bool PositionalFileReader::isOpen() const {
+#if _WIN32
+  return m_shared && m_shared->handle != nullptr;
+#else
+  return m_shared && m_shared->fd >= 0;
+#endif
+}
+
+void PositionalFileReader::seek(atInt64 pos, SeekOrigin origin) {
+  if (!isOpen())
+    return;
+
+  atUint64 offset = m_offset;
+  switch (origin) {
+  case SeekOrigin::Begin:
+    offset = pos;
+    break;
+  case SeekOrigin::Current:
+    offset += pos;
+    break;
+  case SeekOrigin::End:
+    offset = m_shared->length - pos;
+    break;
+  }
+
+  if (offset > m_shared->length) {
+    if (m_globalErr)
+      atError(fmt("Unable to seek in file"));
+    setError();
+    return;
+  }
+
+  m_offset = offset;
+}
+
+atUint64 PositionalFileReader::length() const {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError(fmt("File not open"));
+    return 0;
+  }
+
+  return m_shared->length;
+}
+
+const PositionalFileReader::Block* PositionalFileReader::block(atUint64 index) {
+  if (m_block && m_block->index == index)
+    return m_block.get();
+
+  if (m_shared->cacheBlocks > 0) {
+    m_block = m_shared->loadBlock(index);
+  } else {
+    auto block = std::make_shared<Block>();
+    block->index = index;
+    block->data.reset(new atUint8[m_shared->blockSize]);
+    block->size = m_shared->pread(index * m_shared->blockSize, block->data.get(), m_shared->blockSize);
+    m_block = std::move(block);
+  }
+  return m_block.get();
+}
+
+atUint64 PositionalFileReader::readUBytesToBuf(void* buf, atUint64 len) {
+  if (!isOpen()) {
+    if (m_globalErr)
+      atError(fmt("File not open for reading"));
+    setError();
+    return 0;
+  }
+
+  if (m_offset >= m_shared->length)
+    return 0;
+  len = std::min(len, m_shared->length - m_offset);
+
+  // Large reads gain nothing from the cache
+  if (len >= atUint64(m_shared->blockSize)) {
+    atUint64 ret = m_shared->pread(m_offset, buf, len);
+    m_offset += ret;
+    return ret;
+  }
+
+  const atUint64 blockSize = m_shared->blockSize;
+  atUint64 index = m_offset / blockSize;
+  atUint64 blockOffset = m_offset % blockSize;
+  atUint64 rem = len;
+  atUint8* dst = reinterpret_cast<atUint8*>(buf);
+
+  while (rem) {
+    const Block* cur = block(index);
+    if (blockOffset >= cur->size)
+      break;
+
+    atUint64 copySize = std::min(rem, cur->size - blockOffset);
+    memmove(dst, cur->data.get() + blockOffset, copySize);
+    dst += copySize;
+    rem -= copySize;
+    blockOffset = 0;
+    ++index;
+  }
+
+  atUint64 ret = atUint64(dst - reinterpret_cast<atUint8*>(buf));
+  m_offset += ret;
+  return ret;
+}
+
+atUint64 PositionalFileReader::readAt(atUint64 offset, void* buf, atUint64 len) const {
+  if (!isOpen() || offset >= m_shared->length)
+    return 0;
+  return m_shared->pread(offset, buf, std::min(len, m_shared->length - offset));
+}
+
+atUint64 PositionalFileReader::cacheHits() const { return m_shared ? m_shared->hits.load() : 0; }
+
+atUint64 PositionalFileReader::cacheMisses() const { return m_shared ? m_shared->misses.load() : 0; }
+
+} // namespace athena::io
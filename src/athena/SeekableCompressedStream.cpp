@@ -0,0 +1,441 @@
+#include "athena/SeekableCompressedStream.hpp"
+#include "athena/Checksums.hpp"
+#include "athena/ParallelFor.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <zlib.h>
+
+namespace athena::io {
+namespace {
+constexpr atUint32 Magic = 0x4B484341; // 'ACHK'
+constexpr atUint16 Version = 1;
+constexpr atUint32 HeaderSize = 0x10;
+constexpr atUint32 FooterSize = 0x18;
+constexpr atUint32 IndexEntrySize = 0x10;
+
+// LZ77 headers store the decompressed size in 24 bits
+constexpr atUint32 MaxBlockSize = 0xFFFFFF;
+
+// Whole blocks decompressed per thread before the next batch is read from the source
+constexpr size_t JobsPerThread = 4;
+} // Anonymous namespace
+
+SeekableCompressedWriter::SeekableCompressedWriter(std::unique_ptr<IStreamWriter>&& destination, ChunkCodec codec,
+                                                   atUint32 blockSize, bool globalErr)
+: m_destination(std::move(destination))
+, m_codec(codec)
+, m_blockSize(std::clamp(blockSize, 1u, MaxBlockSize))
+, m_block(m_blockSize)
+, m_globalErr(globalErr) {
+  if (!m_destination || m_destination->hasError()) {
+    if (m_globalErr)
+      atError(fmt("Invalid compression destination"));
+    setError();
+    return;
+  }
+
+  switch (m_codec) {
+  case ChunkCodec::Zlib:
+    m_zlib = std::make_unique<Compression::ZlibCompressor>();
+    break;
+  case ChunkCodec::Yaz0:
+    m_yaz0 = std::make_unique<Compression::Yaz0Encoder>();
+    break;
+  case ChunkCodec::LZ10:
+  case ChunkCodec::LZ11:
+    m_lz = std::make_unique<Compression::LZ77Codec>();
+    break;
+  }
+
+  m_destination->setEndian(Endian::Little);
+  m_start = m_destination->position();
+  m_destination->writeUint32(Magic);
+  m_destination->writeUint16(Version);
+  m_destination->writeUByte(atUint8(m_codec));
+  m_destination->writeUByte(0);
+  m_destination->writeUint32(m_blockSize);
+  m_destination->writeUint32(0);
+}
+
+SeekableCompressedWriter::~SeekableCompressedWriter() {
+  if (m_destination)
+    finish();
+}
+
+bool SeekableCompressedWriter::flushBlock() {
+  if (!m_blockUsed)
+    return true;
+
+  const atUint8* data = m_block.data();
+  const atUint32 len = atUint32(m_blockUsed);
+  atUint64 compressedLen = 0;
+  switch (m_codec) {
+  case ChunkCodec::Zlib: {
+    m_compressed.resize(compressBound(len));
+    const atInt32 ret = m_zlib->compress(data, len, m_compressed.data(), atUint32(m_compressed.size()));
+    compressedLen = ret > 0 ? atUint64(ret) : len;
+    break;
+  }
+  case ChunkCodec::Yaz0:
+    m_compressed.resize(Compression::Yaz0Encoder::maxEncodedSize(len));
+    compressedLen = m_yaz0->encode(data, len, m_compressed.data());
+    break;
+  case ChunkCodec::LZ10:
+  case ChunkCodec::LZ11: {
+    atUint8* lz = nullptr;
+    compressedLen = m_lz->compress(data, len, &lz, m_codec == ChunkCodec::LZ11);
+    m_compressed.assign(lz, lz + compressedLen);
+    delete[] lz;
+    break;
+  }
+  }
+
+  // Blocks that don't shrink are stored, the reader tells them apart by their size
+  const atUint8* out = m_compressed.data();
+  if (compressedLen >= len) {
+    out = data;
+    compressedLen = len;
+  }
+
+  m_index.push_back({m_destination->position() - m_start, atUint32(compressedLen), checksums::crc32(data, len)});
+  m_destination->writeUBytes(out, compressedLen);
+  m_blockUsed = 0;
+
+  if (m_destination->hasError()) {
+    if (m_globalErr)
+      atError(fmt("Unable to write compressed data"));
+    setError();
+    return false;
+  }
+  return true;
+}
+
+void SeekableCompressedWriter::finish() {
+  if (!m_destination || m_finished || hasError())
+    return;
+  m_finished = true;
+  if (!flushBlock())
+    return;
+
+  const atUint64 indexOffset = m_destination->position() - m_start;
+  for (const IndexEntry& entry : m_index) {
+    m_destination->writeUint64(entry.offset);
+    m_destination->writeUint32(entry.compressedSize);
+    m_destination->writeUint32(entry.crc);
+  }
+
+  m_destination->writeUint64(indexOffset);
+  m_destination->writeUint64(m_position);
+  m_destination->writeUint32(atUint32(m_index.size()));
+  m_destination->writeUint32(Magic);
+}
+
+void SeekableCompressedWriter::seek(atInt64 pos, SeekOrigin origin) { seekForwardWithZeros(pos, origin, m_globalErr); }
+
+void SeekableCompressedWriter::writeUBytes(const atUint8* data, atUint64 len) {
+  if (!m_destination || m_finished || hasError()) {
+    if (m_globalErr)
+      atError(fmt("Compressed stream is not open for writing"));
+    setError();
+    return;
+  }
+
+  while (len) {
+    const size_t copySize = size_t(std::min<atUint64>(len, m_block.size() - m_blockUsed));
+    memcpy(m_block.data() + m_blockUsed, data, copySize);
+    m_blockUsed += copySize;
+    m_position += copySize;
+    data += copySize;
+    len -= copySize;
+
+    if (m_blockUsed == m_block.size() && !flushBlock())
+      return;
+  }
+}
+
+SeekableCompressedReader::SeekableCompressedReader(std::unique_ptr<IStreamReader>&& source, atUint32 cacheBlocks,
+                                                   atUint32 threads, bool globalErr)
+: m_source(std::move(source))
+, m_cache(std::max(cacheBlocks, 2u))
+, m_decoders(std::max(threads, 1u))
+, m_globalErr(globalErr) {
+  if (!m_source || m_source->hasError()) {
+    if (m_globalErr)
+      atError(fmt("Invalid decompression source"));
+    setError();
+    return;
+  }
+
+  m_source->setEndian(Endian::Little);
+  m_sourceStart = m_source->position();
+  if (!readIndex()) {
+    m_index.clear();
+    m_length = 0;
+    if (m_globalErr)
+      atError(fmt("Invalid seekable compressed stream"));
+    setError();
+  }
+}
+
+SeekableCompressedReader::~SeekableCompressedReader() = default;
+
+bool SeekableCompressedReader::readIndex() {
+  // The index is found from the footer, so the container has to end the source
+  const atUint64 sourceLength = m_source->length();
+  if (sourceLength < m_sourceStart + HeaderSize + FooterSize)
+    return false;
+  const atUint64 containerLength = sourceLength - m_sourceStart;
+
+  const atUint32 magic = m_source->readUint32();
+  const atUint16 version = m_source->readUint16();
+  const atUint8 codec = m_source->readUByte();
+  m_source->readUByte();
+  m_blockSize = m_source->readUint32();
+  if (magic != Magic || version != Version || codec > atUint8(ChunkCodec::LZ11) || m_blockSize == 0 ||
+      m_blockSize > MaxBlockSize)
+    return false;
+  m_codec = ChunkCodec(codec);
+
+  m_source->seek(sourceLength - FooterSize, SeekOrigin::Begin);
+  const atUint64 indexOffset = m_source->readUint64();
+  m_length = m_source->readUint64();
+  const atUint32 blockCount = m_source->readUint32();
+  if (m_source->readUint32() != Magic || m_source->hasError())
+    return false;
+
+  // The index sits right before the footer, which also bounds how large it can claim to be
+  if (indexOffset < HeaderSize || indexOffset > containerLength - FooterSize ||
+      (containerLength - FooterSize - indexOffset) != atUint64(blockCount) * IndexEntrySize ||
+      blockCount != m_length / m_blockSize + (m_length % m_blockSize != 0))
+    return false;
+  if (m_length != 0 && blockCount == 0)
+    return false;
+
+  m_index.resize(blockCount);
+  m_source->seek(m_sourceStart + indexOffset, SeekOrigin::Begin);
+  for (atUint64 i = 0; i < m_index.size(); ++i) {
+    IndexEntry& entry = m_index[i];
+    entry.offset = m_source->readUint64();
+    entry.compressedSize = m_source->readUint32();
+    entry.crc = m_source->readUint32();
+    if (entry.offset < HeaderSize || entry.offset > indexOffset || indexOffset - entry.offset < entry.compressedSize ||
+        entry.compressedSize > blockLength(i))
+      return false;
+  }
+
+  return !m_source->hasError();
+}
+
+atUint32 SeekableCompressedReader::blockLength(atUint64 block) const {
+  return atUint32(std::min<atUint64>(m_blockSize, m_length - block * m_blockSize));
+}
+
+SeekableCompressedReader::CacheEntry* SeekableCompressedReader::findCached(atUint64 block) {
+  for (CacheEntry& entry : m_cache) {
+    if (entry.block == block) {
+      entry.lastUse = ++m_useCounter;
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+SeekableCompressedReader::CacheEntry& SeekableCompressedReader::allocateCached(atUint64 block) {
+  CacheEntry& entry = *std::min_element(m_cache.begin(), m_cache.end(), [](const CacheEntry& a, const CacheEntry& b) {
+    return a.lastUse < b.lastUse;
+  });
+  entry.block = block;
+  entry.lastUse = ++m_useCounter;
+  entry.data.resize(m_blockSize);
+  return entry;
+}
+
+bool SeekableCompressedReader::decodeJob(Decoder& decoder, Job& job) const {
+  const IndexEntry& entry = m_index[job.block];
+  const atUint32 len = blockLength(job.block);
+  const atUint8* src = job.compressed.data();
+
+  if (entry.compressedSize == len) {
+    memcpy(job.dst, src, len);
+  } else {
+    switch (m_codec) {
+    case ChunkCodec::Zlib:
+      if (!decoder.zlib)
+        decoder.zlib = std::make_unique<Compression::ZlibDecompressor>();
+      if (decoder.zlib->decompress(src, entry.compressedSize, job.dst, len) != atInt32(len))
+        return false;
+      break;
+    case ChunkCodec::Yaz0: {
+      size_t decodedLen;
+      if (Compression::yaz0Decode(src, entry.compressedSize, job.dst, len, decodedLen) != Compression::Status::Ok)
+        return false;
+      break;
+    }
+    case ChunkCodec::LZ10:
+    case ChunkCodec::LZ11: {
+      // The LZ77 header must agree with the index
+      const atUint8 type = m_codec == ChunkCodec::LZ11 ? 0x11 : 0x10;
+      if (entry.compressedSize < 4 || src[0] != type)
+        return false;
+
+      if (!decoder.lz)
+        decoder.lz = std::make_unique<Compression::LZ77Codec>();
+      size_t decodedLen;
+      if (decoder.lz->decompress(src, entry.compressedSize, job.dst, len, decodedLen) != Compression::Status::Ok ||
+          decodedLen != len)
+        return false;
+      break;
+    }
+    }
+  }
+
+  return checksums::crc32(job.dst, len) == entry.crc;
+}
+
+bool SeekableCompressedReader::runJobs(std::vector<Job>& jobs) {
+  // Reading the source is serial, only decompression runs on several threads
+  for (Job& job : jobs) {
+    const IndexEntry& entry = m_index[job.block];
+    job.compressed.resize(entry.compressedSize);
+    job.ok = false;
+    m_source->seek(m_sourceStart + entry.offset, SeekOrigin::Begin);
+    if (m_source->readUBytesToBuf(job.compressed.data(), entry.compressedSize) != entry.compressedSize) {
+      if (m_globalErr)
+        atError(fmt("Unable to read compressed block"));
+      setError();
+      return false;
+    }
+  }
+
+  // One decoder per thread
+  parallelFor(jobs.size(), atUint32(m_decoders.size()),
+              [&](atUint32 worker, size_t i) { jobs[i].ok = decodeJob(m_decoders[worker], jobs[i]); });
+
+  for (const Job& job : jobs) {
+    if (!job.ok) {
+      if (m_globalErr)
+        atError(fmt("Compressed block {} is corrupt"), job.block);
+      setError();
+      return false;
+    }
+  }
+  return true;
+}
+
+const SeekableCompressedReader::CacheEntry* SeekableCompressedReader::loadBlock(atUint64 block) {
+  if (CacheEntry* entry = findCached(block))
+    return entry;
+
+  CacheEntry& entry = allocateCached(block);
+  std::vector<Job> jobs(1);
+  jobs[0].block = block;
+  jobs[0].dst = entry.data.data();
+  if (!runJobs(jobs)) {
+    entry.block = ~atUint64(0);
+    entry.lastUse = 0;
+    return nullptr;
+  }
+  return &entry;
+}
+
+void SeekableCompressedReader::resetWindow(atUint64 offset) {
+  m_windowBegin = m_cur = m_end = nullptr;
+  m_windowOffset = offset;
+}
+
+bool SeekableCompressedReader::underflow(atUint64 len) {
+  const atUint64 pos = position();
+  resetWindow(pos);
+  if (hasError() || pos >= m_length)
+    return false;
+
+  const atUint64 block = pos / m_blockSize;
+  const CacheEntry* entry = loadBlock(block);
+  if (!entry)
+    return false;
+
+  // Expose the rest of the block
+  m_windowBegin = entry->data.data();
+  m_windowOffset = block * m_blockSize;
+  m_cur = m_windowBegin + (pos - m_windowOffset);
+  m_end = m_windowBegin + blockLength(block);
+  return atUint64(m_end - m_cur) >= len;
+}
+
+void SeekableCompressedReader::seek(atInt64 pos, SeekOrigin origin) {
+  atInt64 target = 0;
+  switch (origin) {
+  case SeekOrigin::Begin:
+    target = pos;
+    break;
+  case SeekOrigin::Current:
+    target = atInt64(position()) + pos;
+    break;
+  case SeekOrigin::End:
+    target = atInt64(m_length) - pos;
+    break;
+  }
+
+  if (target < 0 || atUint64(target) > m_length) {
+    if (m_globalErr)
+      atError(fmt("Unable to seek in stream"));
+    setError();
+    return;
+  }
+
+  // Stay within the current block if possible
+  if (m_windowBegin && atUint64(target) >= m_windowOffset &&
+      atUint64(target) - m_windowOffset <= atUint64(m_end - m_windowBegin))
+    m_cur = m_windowBegin + (atUint64(target) - m_windowOffset);
+  else
+    resetWindow(atUint64(target));
+}
+
+atUint64 SeekableCompressedReader::readUBytesToBuf(void* buf, atUint64 len) {
+  const atUint64 pos = position();
+  resetWindow(pos);
+  if (hasError() || pos >= m_length || !len)
+    return 0;
+  len = std::min(len, m_length - pos);
+
+  atUint8* dst = reinterpret_cast<atUint8*>(buf);
+  const atUint64 first = pos / m_blockSize;
+  const atUint64 last = (pos + len - 1) / m_blockSize;
+  const size_t batchSize = m_decoders.size() * JobsPerThread;
+  std::vector<Job> jobs;
+  jobs.reserve(std::min<atUint64>(batchSize, last - first + 1));
+
+  for (atUint64 block = first; block <= last; ++block) {
+    const atUint64 blockBegin = block * m_blockSize;
+    const atUint64 blockEnd = blockBegin + blockLength(block);
+    const atUint64 begin = std::max(pos, blockBegin);
+    const atUint64 end = std::min(pos + len, blockEnd);
+    atUint8* out = dst + (begin - pos);
+
+    // Blocks read in their entirety skip the cache
+    if (begin == blockBegin && end == blockEnd && !findCached(block)) {
+      jobs.push_back({block, out, {}, false});
+      if (jobs.size() == batchSize) {
+        if (!runJobs(jobs))
+          return 0;
+        jobs.clear();
+      }
+      continue;
+    }
+
+    const CacheEntry* entry = loadBlock(block);
+    if (!entry)
+      return 0;
+    memcpy(out, entry->data.data() + (begin - blockBegin), end - begin);
+  }
+
+  if (!jobs.empty() && !runJobs(jobs))
+    return 0;
+
+  resetWindow(pos + len);
+  return len;
+}
+
+} // namespace athena::io
@@ -0,0 +1,183 @@
+#include "athena/SegmentedWriter.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#if !_WIN32 && !defined(GEKKO) && !defined(__SWITCH__)
+#define AT_WRITEV 1
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace athena::io {
+namespace {
+// Stays well below IOV_MAX on every platform that has writev
+constexpr size_t MaxIovecs = 256;
+} // Anonymous namespace
+
+SegmentedWriter::SegmentedWriter(atUint32 segmentSize) : m_segmentShift(0) {
+  while ((atUint64(1) << m_segmentShift) < std::max(segmentSize, 0x100u))
+    ++m_segmentShift;
+}
+
+void SegmentedWriter::seek(atInt64 position, SeekOrigin origin) {
+  atInt64 target = 0;
+  switch (origin) {
+  case SeekOrigin::Begin:
+    target = position;
+    break;
+  case SeekOrigin::Current:
+    target = atInt64(m_position) + position;
+    break;
+  case SeekOrigin::End:
+    target = atInt64(m_length) - position;
+    break;
+  }
+
+  if (target < 0) {
+    atError(fmt("Position outside stream bounds"));
+    setError();
+    return;
+  }
+
+  if (atUint64(target) > m_length) {
+    reserve(atUint64(target));
+    zeroFill(m_length, atUint64(target));
+    m_length = atUint64(target);
+  }
+
+  m_position = atUint64(target);
+}
+
+atUint64 SegmentedWriter::segmentLength(size_t idx) const {
+  const atUint64 begin = atUint64(idx) << m_segmentShift;
+  if (begin >= m_length)
+    return 0;
+  return std::min<atUint64>(segmentSize(), m_length - begin);
+}
+
+void SegmentedWriter::flattenTo(atUint8* dst) const {
+  const size_t count = segmentCount();
+  for (size_t i = 0; i < count; ++i) {
+    const atUint64 len = segmentLength(i);
+    memcpy(dst, m_segments[i].get(), len);
+    dst += len;
+  }
+}
+
+atUint8* SegmentedWriter::data() const {
+  atUint8* ret = new atUint8[m_length];
+  flattenTo(ret);
+  return ret;
+}
+
+void SegmentedWriter::writeTo(IStreamWriter& writer) const {
+  const size_t count = segmentCount();
+  for (size_t i = 0; i < count; ++i)
+    writer.writeUBytes(m_segments[i].get(), segmentLength(i));
+}
+
+void SegmentedWriter::save(std::string_view filename) {
+  const std::string path(filename);
+#if AT_WRITEV
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  if (fd < 0) {
+    atError(fmt("Unable to open file '{}'"), path);
+    setError();
+    return;
+  }
+
+  std::vector<iovec> iov(segmentCount());
+  for (size_t i = 0; i < iov.size(); ++i) {
+    iov[i].iov_base = m_segments[i].get();
+    iov[i].iov_len = size_t(segmentLength(i));
+  }
+
+  size_t first = 0;
+  while (first < iov.size()) {
+    const int count = int(std::min(iov.size() - first, MaxIovecs));
+    ssize_t ret = ::writev(fd, &iov[first], count);
+    if (ret < 0 && errno == EINTR)
+      continue;
+    if (ret <= 0) {
+      atError(fmt("Error writing data to disk"));
+      setError();
+      break;
+    }
+
+    // Skip what went out and trim a partially written segment
+    size_t done = size_t(ret);
+    while (first < iov.size() && done >= iov[first].iov_len)
+      done -= iov[first++].iov_len;
+    if (done) {
+      iov[first].iov_base = static_cast<atUint8*>(iov[first].iov_base) + done;
+      iov[first].iov_len -= done;
+    }
+  }
+
+  ::close(fd);
+#else
+  std::unique_ptr<FILE, decltype(&std::fclose)> out{std::fopen(path.c_str(), "wb"), std::fclose};
+  if (!out) {
+    atError(fmt("Unable to open file '{}'"), path);
+    setError();
+    return;
+  }
+
+  const size_t count = segmentCount();
+  for (size_t i = 0; i < count; ++i) {
+    const atUint64 len = segmentLength(i);
+    if (std::fwrite(m_segments[i].get(), 1, len, out.get()) != len) {
+      atError(fmt("Error writing data to disk"));
+      setError();
+      return;
+    }
+  }
+#endif
+}
+
+void SegmentedWriter::clear() {
+  m_position = 0;
+  m_length = 0;
+}
+
+void SegmentedWriter::reserve(atUint64 size) {
+  const size_t needed = size_t((size + segmentSize() - 1) >> m_segmentShift);
+  while (m_segments.size() < needed)
+    m_segments.emplace_back(new atUint8[segmentSize()]);
+}
+
+void SegmentedWriter::zeroFill(atUint64 begin, atUint64 end) {
+  while (begin < end) {
+    const atUint64 offset = begin & (segmentSize() - 1);
+    const atUint64 len = std::min<atUint64>(end - begin, segmentSize() - offset);
+    memset(m_segments[begin >> m_segmentShift].get() + offset, 0, len);
+    begin += len;
+  }
+}
+
+void SegmentedWriter::writeUBytes(const atUint8* data, atUint64 length) {
+  if (!data) {
+    atError(fmt("data cannnot be NULL"));
+    setError();
+    return;
+  }
+
+  const atUint64 end = m_position + length;
+  reserve(end);
+
+  while (m_position < end) {
+    const atUint64 offset = m_position & (segmentSize() - 1);
+    const atUint64 len = std::min<atUint64>(end - m_position, segmentSize() - offset);
+    memcpy(m_segments[m_position >> m_segmentShift].get() + offset, data, len);
+    data += len;
+    m_position += len;
+  }
+
+  m_length = std::max(m_length, m_position);
+}
+
+} // namespace athena::io
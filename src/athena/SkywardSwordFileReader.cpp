@@ -9,7 +9,8 @@ SkywardSwordFileReader::SkywardSwordFileReader(atUint8* data, atUint64 length) :
   setEndian(Endian::Big);
 }
 
-SkywardSwordFileReader::SkywardSwordFileReader(const std::string& filename) : MemoryCopyReader(filename) {
+SkywardSwordFileReader::SkywardSwordFileReader(const std::string& filename, bool mapFile)
+: MemoryCopyReader(filename, mapFile ? Load::Map : Load::Copy) {
   setEndian(Endian::Big);
 }
 
@@ -8,7 +8,8 @@
 namespace athena::io {
 SpriteFileReader::SpriteFileReader(atUint8* data, atUint64 length) : MemoryCopyReader(data, length) {}
 
-SpriteFileReader::SpriteFileReader(const std::string& filepath) : MemoryCopyReader(filepath) {}
+SpriteFileReader::SpriteFileReader(const std::string& filepath, bool mapFile)
+: MemoryCopyReader(filepath, mapFile ? Load::Map : Load::Copy) {}
 
 Sakura::SpriteFile* SpriteFileReader::readFile() {
   Sakura::SpriteFile* ret = NULL;
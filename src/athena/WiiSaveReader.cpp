@@ -9,6 +9,7 @@
 #include "aes.hpp"
 #include "ec.hpp"
 #include "sha1.h"
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <cstring>
@@ -21,7 +22,10 @@ WiiSaveReader::WiiSaveReader(const atUint8* data, atUint64 length) : MemoryCopyR
   setEndian(Endian::Big);
 }
 
-WiiSaveReader::WiiSaveReader(const std::string& filename) : MemoryCopyReader(filename) { setEndian(Endian::Big); }
+WiiSaveReader::WiiSaveReader(const std::string& filename, bool mapFile)
+: MemoryCopyReader(filename, mapFile ? Load::Map : Load::Copy) {
+  setEndian(Endian::Big);
+}
 
 std::unique_ptr<WiiSave> WiiSaveReader::readSave() {
   WiiSave* ret = new WiiSave;
@@ -238,25 +242,28 @@ WiiFile* WiiSaveReader::readFile() {
   permissions = readByte();
   attributes = readByte();
   type = (WiiFile::Type)readByte();
-  name = std::string((const char*)readBytes(0x45).get());
+  ByteView nameView = readView(0x45);
+  name = std::string((const char*)nameView.data, std::find(nameView.begin(), nameView.end(), 0) - nameView.begin());
   ret = new WiiFile(std::string(name));
   ret->setPermissions(permissions);
   ret->setAttributes(attributes);
   ret->setType((WiiFile::Type)type);
-  std::unique_ptr<atUint8[]> iv = readUBytes(0x10);
+  atUint8 iv[0x10] = {};
+  readUBytesToBuf(iv, 0x10);
   seek(0x20);
 
   if (type == WiiFile::File) {
-    // Read file data
+    // Read file data, decrypting straight out of the save's buffer
     int roundedLen = (fileLen + 63) & ~63;
-    std::unique_ptr<atUint8[]> filedata = readUBytes(roundedLen);
+    ByteView filedata = readView(roundedLen);
 
     // Decrypt file
     std::cout << "Decrypting: " << ret->filename() << "...";
     atUint8* decData = new atUint8[roundedLen];
+    memset(decData + filedata.size, 0, roundedLen - filedata.size);
     std::unique_ptr<IAES> aes = NewAES();
     aes->setKey(SD_KEY);
-    aes->decrypt(iv.get(), filedata.get(), decData, roundedLen);
+    aes->decrypt(iv, filedata.data, decData, filedata.size);
     ret->setData(decData);
     ret->setLength(fileLen);
     std::cout << "done" << std::endl;
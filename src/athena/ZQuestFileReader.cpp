@@ -4,6 +4,7 @@
 #include "athena/Checksums.hpp"
 #include "athena/Utility.hpp"
 
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 
@@ -11,7 +12,8 @@ namespace athena::io {
 
 ZQuestFileReader::ZQuestFileReader(atUint8* data, atUint64 length) : MemoryCopyReader(data, length) {}
 
-ZQuestFileReader::ZQuestFileReader(const std::string& filename) : MemoryCopyReader(filename) {}
+ZQuestFileReader::ZQuestFileReader(const std::string& filename, bool mapFile)
+: MemoryCopyReader(filename, mapFile ? Load::Map : Load::Copy) {}
 
 ZQuestFile* ZQuestFileReader::read() {
   atUint32 magic, version, compressedLen, uncompressedLen;
@@ -38,7 +40,8 @@ ZQuestFile* ZQuestFileReader::read() {
   uncompressedLen = readUint32();
 
   if (version >= ZQUEST_VERSION_CHECK(2, 0, 0)) {
-    gameString = std::string((const char*)readBytes(0x0A).get(), 0x0A);
+    ByteView gameView = readView(0x0A);
+    gameString = std::string((const char*)gameView.data, gameView.size);
 
     for (size_t i = 0; i < ZQuestFile::gameStringList().size(); i++) {
       if (ZQuestFile::gameStringList().at(i).substr(0, 0x0A) == gameString) {
@@ -56,10 +59,15 @@ ZQuestFile* ZQuestFileReader::read() {
     seek(0x0A);
   }
 
-  std::unique_ptr<atUint8[]> data = readUBytes(compressedLen); // compressedLen is always the total file size
+  // compressedLen is always the total file size; checksum and inflate it in place
+  ByteView view = readView(compressedLen);
+  if (view.size != compressedLen) {
+    atError("Unexpected end of ZQuest data");
+    return nullptr;
+  }
 
   if (version >= ZQUEST_VERSION_CHECK(2, 0, 0)) {
-    if (checksum != athena::checksums::crc32(data.get(), compressedLen)) {
+    if (checksum != athena::checksums::crc32(view.data, compressedLen)) {
       atError("Checksum mismatch, data corrupt");
       return nullptr;
     }
@@ -69,17 +77,16 @@ ZQuestFile* ZQuestFileReader::read() {
     std::clog << " has no checksum field" << std::endl;
   }
 
+  std::unique_ptr<atUint8[]> data(new atUint8[uncompressedLen]);
   if (compressedLen != uncompressedLen) {
-    atUint8* dst = new atUint8[uncompressedLen];
-    atUint32 dstLen = io::Compression::decompressZlib(data.get(), compressedLen, dst, uncompressedLen);
+    atUint32 dstLen = io::Compression::decompressZlib(view.data, compressedLen, data.get(), uncompressedLen);
 
     if (dstLen != uncompressedLen) {
-      delete[] dst;
       atError("Error decompressing data");
       return nullptr;
     }
-
-    data.reset(dst);
+  } else {
+    memcpy(data.get(), view.data, compressedLen);
   }
 
   return new ZQuestFile(game, BOM == 0xFEFF ? Endian::Big : Endian::Little, std::move(data), uncompressedLen,
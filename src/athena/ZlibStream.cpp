@@ -0,0 +1,153 @@
+#include "athena/ZlibStream.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include <zlib.h>
+
+namespace athena::io {
+namespace {
+// zlib keeps its own window, the buffer only has to hold what has not been read yet
+constexpr atUint32 ZlibHistory = 0;
+constexpr atUint32 ZlibMaxRun = 0;
+
+constexpr uInt clampAvail(size_t len) { return uInt(std::min<size_t>(len, UINT_MAX)); }
+} // Anonymous namespace
+
+ZlibReader::ZlibReader(std::unique_ptr<IStreamReader>&& source, atInt32 windowBits, atUint64 length, bool globalErr)
+: DecompressReader(std::move(source), ZlibHistory, ZlibMaxRun, globalErr)
+, m_stream(std::make_unique<z_stream_s>())
+, m_knownLength(length) {
+  if (inflateInit2(m_stream.get(), windowBits) != Z_OK) {
+    m_stream.reset();
+    if (globalErr)
+      atError(fmt("Unable to initialize zlib"));
+    setError();
+    return;
+  }
+  start();
+}
+
+ZlibReader::~ZlibReader() {
+  if (m_stream)
+    inflateEnd(m_stream.get());
+}
+
+bool ZlibReader::readHeader(atUint64& length) {
+  // inflate parses the header itself
+  if (!m_stream || inflateReset(m_stream.get()) != Z_OK)
+    return false;
+  m_streamEnd = false;
+  length = m_knownLength;
+  return true;
+}
+
+atUint8* ZlibReader::decode(atUint8* out, atUint8* limit, atUint8* /*end*/) {
+  m_stream->next_out = out;
+  m_stream->avail_out = clampAvail(size_t(limit - out));
+
+  while (m_stream->avail_out && !m_streamEnd) {
+    const atUint8* data;
+    size_t len;
+    if (!peekInput(data, len))
+      return nullptr;
+
+    m_stream->next_in = const_cast<Bytef*>(data);
+    m_stream->avail_in = clampAvail(len);
+    const int ret = inflate(m_stream.get(), Z_NO_FLUSH);
+    consumeInput(size_t(m_stream->next_in - data));
+
+    if (ret == Z_STREAM_END)
+      m_streamEnd = true;
+    else if (ret != Z_OK)
+      return nullptr;
+  }
+
+  return m_stream->next_out;
+}
+
+ZlibWriter::ZlibWriter(std::unique_ptr<IStreamWriter>&& destination, atInt32 level, atInt32 windowBits,
+                       atUint32 bufferSize, bool globalErr)
+: m_destination(std::move(destination))
+, m_stream(std::make_unique<z_stream_s>())
+, m_input(std::max(bufferSize, 1u))
+, m_output(std::max(bufferSize, 1u))
+, m_globalErr(globalErr) {
+  if (!m_destination ||
+      deflateInit2(m_stream.get(), level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    m_stream.reset();
+    if (m_globalErr)
+      atError(fmt("Unable to initialize zlib"));
+    setError();
+  }
+}
+
+ZlibWriter::~ZlibWriter() {
+  if (m_stream) {
+    finish();
+    deflateEnd(m_stream.get());
+  }
+}
+
+atUint64 ZlibWriter::compressedLength() const { return m_stream ? m_stream->total_out : 0; }
+
+bool ZlibWriter::deflateInput(atInt32 flush) {
+  m_stream->next_in = m_input.data();
+  m_stream->avail_in = clampAvail(m_inputUsed);
+
+  int ret;
+  do {
+    m_stream->next_out = m_output.data();
+    m_stream->avail_out = clampAvail(m_output.size());
+    ret = deflate(m_stream.get(), flush);
+    if (ret == Z_STREAM_ERROR)
+      break;
+
+    const size_t produced = m_output.size() - m_stream->avail_out;
+    if (produced)
+      m_destination->writeUBytes(m_output.data(), produced);
+    // A full output buffer means deflate may have more to give
+  } while (m_stream->avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+
+  m_inputUsed = 0;
+  if (ret == Z_STREAM_ERROR || m_destination->hasError()) {
+    if (m_globalErr)
+      atError(fmt("Unable to write compressed data"));
+    setError();
+    return false;
+  }
+  return true;
+}
+
+void ZlibWriter::finish() {
+  if (!m_stream || m_finished)
+    return;
+  deflateInput(Z_FINISH);
+  m_finished = true;
+}
+
+void ZlibWriter::seek(atInt64 pos, SeekOrigin origin) { seekForwardWithZeros(pos, origin, m_globalErr); }
+
+void ZlibWriter::writeUBytes(const atUint8* data, atUint64 len) {
+  if (!m_stream || m_finished) {
+    if (m_globalErr)
+      atError(fmt("Compressed stream is not open for writing"));
+    setError();
+    return;
+  }
+
+  while (len) {
+    const size_t copySize = size_t(std::min<atUint64>(len, m_input.size() - m_inputUsed));
+    memcpy(m_input.data() + m_inputUsed, data, copySize);
+    m_inputUsed += copySize;
+    m_position += copySize;
+    data += copySize;
+    len -= copySize;
+
+    if (m_inputUsed == m_input.size() && !deflateInput(Z_NO_FLUSH))
+      return;
+  }
+}
+
+} // namespace athena::io